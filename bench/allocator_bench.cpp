@@ -0,0 +1,178 @@
+// Allocator throughput benchmark
+//
+// Replays a synthetic malloc/free trace against MemoryAllocator (all three
+// strategies) and BuddyAllocator, and measures raw node churn through
+// NodePool against plain new/delete.
+//
+// Usage: allocator_bench [operations] [seed]
+
+#include "../include/memory_allocator.h"
+#include "../include/buddy_allocator.h"
+#include "../include/node_pool.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+struct TraceOp
+{
+    bool is_malloc;
+    size_t size;
+    size_t slot; // index into the live-id table for frees
+};
+
+// Mix of allocations and frees that keeps roughly live_target blocks alive
+static vector<TraceOp> makeTrace(size_t operations, unsigned seed, size_t live_target)
+{
+    vector<TraceOp> trace;
+    trace.reserve(operations);
+
+    srand(seed);
+    size_t live = 0;
+
+    for (size_t i = 0; i < operations; i++)
+    {
+        bool do_malloc = live == 0 || (live < live_target ? rand() % 100 < 60 : rand() % 100 < 40);
+        TraceOp op;
+        op.is_malloc = do_malloc;
+        op.size = 16 + rand() % 1024;
+        op.slot = do_malloc ? 0 : rand() % live;
+        trace.push_back(op);
+        live += do_malloc ? 1 : -1;
+    }
+
+    return trace;
+}
+
+// Discards everything written to it
+class NullBuffer : public streambuf
+{
+protected:
+    int overflow(int c) { return c; }
+    streamsize xsputn(const char *, streamsize n) { return n; }
+};
+
+template <typename Allocator>
+static double replay(Allocator &allocator, const vector<TraceOp> &trace)
+{
+    vector<int> live_ids;
+    live_ids.reserve(trace.size());
+
+    auto start = chrono::steady_clock::now();
+
+    for (const TraceOp &op : trace)
+    {
+        if (op.is_malloc)
+        {
+            int id = allocator.malloc(op.size);
+            if (id >= 0)
+            {
+                live_ids.push_back(id);
+            }
+        }
+        else if (!live_ids.empty())
+        {
+            size_t slot = op.slot % live_ids.size();
+            allocator.free(live_ids[slot]);
+            live_ids[slot] = live_ids.back();
+            live_ids.pop_back();
+        }
+    }
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+template <typename Node>
+static double churnNewDelete(size_t rounds, size_t batch)
+{
+    vector<Node *> nodes(batch);
+    auto start = chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < batch; i++)
+            nodes[i] = new Node(i, 64, true, -1);
+        for (size_t i = 0; i < batch; i++)
+            delete nodes[i];
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+template <typename Node>
+static double churnPool(size_t rounds, size_t batch)
+{
+    NodePool<Node> pool;
+    vector<Node *> nodes(batch);
+    auto start = chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < batch; i++)
+            nodes[i] = pool.create(i, 64, true, -1);
+        for (size_t i = 0; i < batch; i++)
+            pool.destroy(nodes[i]);
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+static void report(const string &name, size_t operations, double seconds)
+{
+    cout << setfill(' ') << left << setw(28) << name << right
+         << setw(10) << fixed << setprecision(3) << seconds << " s"
+         << setw(14) << setprecision(0) << (operations / seconds) << " ops/s" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t operations = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    unsigned seed = argc > 2 ? (unsigned)strtoul(argv[2], nullptr, 10) : 42;
+
+    vector<TraceOp> trace = makeTrace(operations, seed, 20000);
+
+    // The allocators log every operation; keep that out of the measurement
+    NullBuffer sink;
+    streambuf *cout_buffer = cout.rdbuf(&sink);
+    streambuf *cerr_buffer = cerr.rdbuf(&sink);
+
+    double times[4];
+    const char *strategies[3] = {"first_fit", "best_fit", "worst_fit"};
+    AllocationStrategy values[3] = {AllocationStrategy::FIRST_FIT, AllocationStrategy::BEST_FIT,
+                                    AllocationStrategy::WORST_FIT};
+
+    for (int i = 0; i < 3; i++)
+    {
+        MemoryAllocator allocator(64 * 1024 * 1024);
+        allocator.setStrategy(values[i]);
+        times[i] = replay(allocator, trace);
+    }
+
+    {
+        BuddyAllocator buddy(64 * 1024 * 1024);
+        times[3] = replay(buddy, trace);
+    }
+
+    cout.rdbuf(cout_buffer);
+    cerr.rdbuf(cerr_buffer);
+
+    cout << "Allocator trace: " << operations << " operations, seed " << seed << endl;
+    for (int i = 0; i < 3; i++)
+    {
+        report(string("MemoryAllocator ") + strategies[i], operations, times[i]);
+    }
+    report("BuddyAllocator", operations, times[3]);
+
+    size_t rounds = 200;
+    size_t batch = 10000;
+    cout << "\nNode churn: " << rounds << " x " << batch << " create/destroy" << endl;
+    report("MemoryBlock new/delete", rounds * batch, churnNewDelete<MemoryBlock>(rounds, batch));
+    report("MemoryBlock NodePool", rounds * batch, churnPool<MemoryBlock>(rounds, batch));
+    report("BuddyBlock new/delete", rounds * batch, churnNewDelete<BuddyBlock>(rounds, batch));
+    report("BuddyBlock NodePool", rounds * batch, churnPool<BuddyBlock>(rounds, batch));
+
+    return 0;
+}
@@ -0,0 +1,312 @@
+// Long-run stress benchmark
+//
+// Replays a synthetic address stream of more than 2^32 accesses (by
+// default) through a CacheLevel under FIFO, LRU and LFU and through
+// VirtualMemory under FIFO, LRU and Clock, and checks every hit or miss
+// against a small reference model of the same policy. Counters or recency
+// timestamps narrower than 64 bits wrap long before the end of the run and
+// make the simulator diverge from the reference.
+//
+// Usage: longrun_bench [accesses] [seed]
+
+#include "../include/cache.h"
+#include "../include/virtual_memory.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+// xorshift64*: cheap enough not to dominate billions of accesses
+struct AddressStream
+{
+    uint64_t state;
+    size_t hot;
+    size_t footprint;
+
+    AddressStream(uint64_t seed, size_t hot_bytes, size_t footprint_bytes)
+        : state(seed * 2685821657736338717ULL + 1), hot(hot_bytes), footprint(footprint_bytes) {}
+
+    size_t next(unsigned cold_per_1024)
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        uint64_t r = state * 2685821657736338717ULL;
+        return (r & 1023) < cold_per_1024 ? (r >> 20) % footprint : (r >> 20) % hot;
+    }
+};
+
+// One set-associative cache, kept as plain per-way timestamps
+class ReferenceCache
+{
+private:
+    struct Way
+    {
+        bool valid;
+        uint64_t tag;
+        uint64_t inserted;
+        uint64_t last_use;
+        uint64_t frequency;
+    };
+
+    size_t block_size;
+    size_t num_sets;
+    size_t associativity;
+    ReplacementPolicy policy;
+    vector<Way> ways;
+    uint64_t clock;
+
+public:
+    ReferenceCache(size_t size, size_t block_sz, size_t assoc, ReplacementPolicy pol)
+        : block_size(block_sz), num_sets(size / (block_sz * assoc)), associativity(assoc),
+          policy(pol), clock(0)
+    {
+        Way empty = {false, 0, 0, 0, 0};
+        ways.assign(num_sets * associativity, empty);
+    }
+
+    bool access(size_t address)
+    {
+        size_t block = address / block_size;
+        Way *set = &ways[(block % num_sets) * associativity];
+        uint64_t tag = block / num_sets;
+        clock++;
+
+        for (size_t w = 0; w < associativity; w++)
+        {
+            if (set[w].valid && set[w].tag == tag)
+            {
+                set[w].last_use = clock;
+                set[w].frequency++;
+                return true;
+            }
+        }
+
+        // Empty ways fill in order, then the policy picks a victim
+        size_t victim = 0;
+        for (size_t w = 0; w < associativity; w++)
+        {
+            if (!set[w].valid)
+            {
+                victim = w;
+                break;
+            }
+
+            const Way &a = set[w], &b = set[victim];
+            bool older;
+            if (policy == ReplacementPolicy::FIFO)
+                older = a.inserted < b.inserted;
+            else if (policy == ReplacementPolicy::LRU)
+                older = a.last_use < b.last_use;
+            else
+                older = a.frequency < b.frequency ||
+                        (a.frequency == b.frequency && a.last_use < b.last_use);
+            if (older)
+                victim = w;
+        }
+
+        Way filled = {true, tag, clock, clock, 1};
+        set[victim] = filled;
+        return false;
+    }
+};
+
+// Resident pages of one VirtualMemory, with frames taken lowest first
+class ReferencePager
+{
+private:
+    PageReplacementPolicy policy;
+    size_t num_frames;
+    size_t used;
+    vector<long long> frame_of; // per page, -1 when not resident
+    vector<size_t> page_in;     // per frame
+    vector<uint64_t> loaded;
+    vector<uint64_t> last_use;
+    vector<bool> referenced;
+    size_t hand;
+    uint64_t clock;
+
+public:
+    ReferencePager(size_t pages, size_t frames, PageReplacementPolicy pol)
+        : policy(pol), num_frames(frames), used(0), frame_of(pages, -1), page_in(frames, 0),
+          loaded(frames, 0), last_use(frames, 0), referenced(frames, false), hand(0), clock(0)
+    {
+    }
+
+    bool access(size_t page)
+    {
+        clock++;
+        if (frame_of[page] >= 0)
+        {
+            last_use[frame_of[page]] = clock;
+            referenced[frame_of[page]] = true;
+            return true;
+        }
+
+        size_t frame;
+        if (used < num_frames)
+        {
+            frame = used++;
+        }
+        else
+        {
+            if (policy == PageReplacementPolicy::CLOCK)
+            {
+                while (referenced[hand])
+                {
+                    referenced[hand] = false;
+                    hand = (hand + 1) % num_frames;
+                }
+                frame = hand;
+                hand = (hand + 1) % num_frames;
+            }
+            else
+            {
+                const vector<uint64_t> &age = policy == PageReplacementPolicy::FIFO ? loaded : last_use;
+                frame = 0;
+                for (size_t f = 1; f < num_frames; f++)
+                {
+                    if (age[f] < age[frame])
+                        frame = f;
+                }
+            }
+            frame_of[page_in[frame]] = -1;
+        }
+
+        frame_of[page] = frame;
+        page_in[frame] = page;
+        loaded[frame] = clock;
+        last_use[frame] = clock;
+        referenced[frame] = true;
+        return false;
+    }
+};
+
+struct RunResult
+{
+    uint64_t hits;
+    uint64_t mismatch_at; // 0 when the run matched the reference throughout
+    double seconds;
+};
+
+static void report(const string &name, uint64_t accesses, const RunResult &r)
+{
+    cout << setfill(' ') << left << setw(22) << name << right
+         << setw(10) << fixed << setprecision(1) << r.seconds << " s"
+         << setw(14) << setprecision(0) << (accesses / r.seconds) << " acc/s"
+         << "   hit ratio " << setprecision(2) << (100.0 * r.hits / accesses) << "%   ";
+    if (r.mismatch_at == 0)
+        cout << "matches reference" << endl;
+    else
+        cout << "MISMATCH at access " << r.mismatch_at << endl;
+}
+
+static RunResult runCache(ReplacementPolicy policy, uint64_t accesses, uint64_t seed)
+{
+    const size_t size = 4096, block_size = 64, assoc = 4;
+    CacheLevel level(size, block_size, assoc, policy);
+    ReferenceCache reference(size, block_size, assoc, policy);
+    AddressStream stream(seed, 96 * block_size, 1 << 16);
+    vector<size_t> block(block_size, 0);
+
+    RunResult result = {0, 0, 0.0};
+    auto start = chrono::steady_clock::now();
+    for (uint64_t i = 1; i <= accesses; i++)
+    {
+        size_t address = stream.next(64);
+        size_t data;
+        bool hit = level.access(address, data);
+        if (!hit)
+        {
+            level.insert(address, block.data());
+        }
+        if (hit != reference.access(address))
+        {
+            result.mismatch_at = i;
+            break;
+        }
+    }
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.hits = level.getHits();
+    return result;
+}
+
+static RunResult runPager(PageReplacementPolicy policy, uint64_t accesses, uint64_t seed)
+{
+    // 256 pages of 256 bytes over 16 frames; faults are rare, so the
+    // translations (and their timestamps) dominate
+    const size_t page_size = 256, pages = 256, frames = 16;
+    VirtualMemory vm(16, 12, page_size, policy);
+    ReferencePager reference(pages, frames, policy);
+    AddressStream stream(seed, 12 * page_size, pages * page_size);
+
+    RunResult result = {0, 0, 0.0};
+    auto start = chrono::steady_clock::now();
+    for (uint64_t i = 1; i <= accesses; i++)
+    {
+        size_t address = stream.next(1);
+        uint64_t faults = vm.getPageFaults();
+        vm.translate(address);
+        bool hit = vm.getPageFaults() == faults;
+        if (hit != reference.access(address / page_size))
+        {
+            result.mismatch_at = i;
+            break;
+        }
+    }
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.hits = vm.getPageHits();
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t accesses = argc > 1 ? strtoull(argv[1], nullptr, 10) : (1ULL << 32) + (1ULL << 20);
+    uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 10) : 42;
+
+    struct
+    {
+        const char *name;
+        ReplacementPolicy policy;
+    } caches[] = {
+        {"cache FIFO", ReplacementPolicy::FIFO},
+        {"cache LRU", ReplacementPolicy::LRU},
+        {"cache LFU", ReplacementPolicy::LFU},
+    };
+
+    struct
+    {
+        const char *name;
+        PageReplacementPolicy policy;
+    } pagers[] = {
+        {"vm FIFO", PageReplacementPolicy::FIFO},
+        {"vm LRU", PageReplacementPolicy::LRU},
+        {"vm Clock", PageReplacementPolicy::CLOCK},
+    };
+
+    cout << "Long run: " << accesses << " accesses per configuration, seed " << seed << endl;
+    bool ok = true;
+
+    for (const auto &c : caches)
+    {
+        RunResult r = runCache(c.policy, accesses, seed);
+        report(c.name, accesses, r);
+        ok = ok && r.mismatch_at == 0;
+    }
+
+    for (const auto &p : pagers)
+    {
+        // VirtualMemory reports every page fault; drop the output meanwhile
+        cout.setstate(ios::badbit);
+        RunResult r = runPager(p.policy, accesses, seed);
+        cout.clear();
+        report(p.name, accesses, r);
+        ok = ok && r.mismatch_at == 0;
+    }
+
+    return ok ? 0 : 1;
+}
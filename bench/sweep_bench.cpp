@@ -0,0 +1,91 @@
+// Cache sweep scaling benchmark
+//
+// Simulates a grid of single-level cache configurations over one synthetic
+// trace with CacheSweep, first on one thread and then on 2, 4, ... up to the
+// number of cores, and reports the speedup over the single-thread run.
+//
+// Usage: sweep_bench [accesses] [seed]
+
+#include "../include/cache_sweep.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+using namespace std;
+
+static vector<TraceAccess> makeTrace(size_t count, unsigned seed, size_t footprint)
+{
+    vector<TraceAccess> trace;
+    trace.reserve(count);
+
+    srand(seed);
+    size_t hot = footprint / 64;
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t r = ((size_t)rand() << 16) ^ (size_t)rand();
+        TraceAccess access;
+        access.address = rand() % 100 < 80 ? r % hot : r % footprint;
+        access.is_write = rand() % 4 == 0;
+        access.data = i;
+        trace.push_back(access);
+    }
+    return trace;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t accesses = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    unsigned seed = argc > 2 ? (unsigned)strtoul(argv[2], nullptr, 10) : 42;
+    size_t footprint = 1 << 20;
+
+    vector<TraceAccess> trace = makeTrace(accesses, seed, footprint);
+
+    // 4 sizes x 2 block sizes x 4 associativities x 3 policies
+    CacheSweep sweep(footprint);
+    ReplacementPolicy policies[] = {ReplacementPolicy::FIFO, ReplacementPolicy::LRU, ReplacementPolicy::LFU};
+    for (size_t size = 4096; size <= 32768; size *= 2)
+    {
+        for (size_t block_size = 32; block_size <= 64; block_size *= 2)
+        {
+            for (size_t assoc = 1; assoc <= 8; assoc *= 2)
+            {
+                for (ReplacementPolicy policy : policies)
+                {
+                    LevelConfig level = {size, block_size, assoc, policy,
+                                         WritePolicy::WRITE_BACK, WriteMissPolicy::WRITE_ALLOCATE};
+                    sweep.addConfig(vector<LevelConfig>(1, level));
+                }
+            }
+        }
+    }
+
+    size_t cores = max(1u, thread::hardware_concurrency());
+    cout << "Cache sweep: " << sweep.getNumConfigs() << " configurations, " << accesses
+         << " accesses, seed " << seed << ", " << cores << " cores" << endl;
+
+    double single = 0;
+    for (size_t threads = 1;; threads = min(threads * 2, cores))
+    {
+        auto start = chrono::steady_clock::now();
+        sweep.run(trace, threads);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        if (threads == 1)
+        {
+            single = elapsed.count();
+        }
+
+        cout << setw(4) << threads << " threads" << setw(10) << fixed << setprecision(3)
+             << elapsed.count() << " s" << setw(10) << setprecision(2)
+             << single / elapsed.count() << "x" << endl;
+
+        if (threads == cores)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
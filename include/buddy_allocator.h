@@ -1,7 +1,9 @@
 #ifndef BUDDY_ALLOCATOR_H
 #define BUDDY_ALLOCATOR_H
 
+#include "node_pool.h"
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <map>
 
@@ -18,21 +20,66 @@ struct BuddyBlock
         : address(addr), size(sz), is_free(free), block_id(id) {}
 };
 
+// Multi-level bitmap. Level 0 has one bit per block; each level above has
+// one bit per non-empty word of the level below, up to a single top word,
+// so finding the first set bit costs one word per level (log64 of the size).
+class BuddyBitmap
+{
+private:
+    vector<vector<uint64_t>> levels;
+
+public:
+    void init(size_t bits);
+
+    bool test(size_t index) const
+    {
+        return (levels[0][index / 64] >> (index % 64)) & 1;
+    }
+
+    void set(size_t index);
+    void clear(size_t index);
+    size_t findFirst() const;
+    size_t bytes() const;
+
+    const vector<uint64_t> &words() const { return levels[0]; }
+};
+
+// Free blocks are not materialized as nodes. For every order k (block size
+// min_block_size << k) a flat bitmap records which aligned blocks of that
+// order are free (about two bits per minimum block in total, which keeps
+// multi-GB arenas with 4 KB blocks at a few MB), so checking a buddy is a
+// single bit test and a free only walks its own buddy chain.
+// nonempty_orders has bit k set while order k has any free block, which
+// gives the smallest usable order in one instruction.
 class BuddyAllocator
 {
 private:
     size_t total_memory;
     size_t min_block_size;
-    map<size_t, vector<BuddyBlock *>> free_lists;
+    size_t min_block_shift;
+    size_t max_order;
+    vector<BuddyBitmap> free_bitmaps;
+    vector<size_t> free_counts;
+    uint64_t nonempty_orders;
+    NodePool<BuddyBlock> block_pool;
     map<int, BuddyBlock *> allocated_blocks;
     map<int, size_t> requested_sizes;
     int next_block_id;
+    size_t used_memory;
+    size_t requested_memory;
+    size_t free_block_count;
 
     size_t roundUpToPowerOf2(size_t size);
     bool isPowerOf2(size_t n);
-    size_t getBuddyAddress(size_t address, size_t size);
-    BuddyBlock *splitBlock(size_t size);
-    void mergeBuddies();
+    size_t log2Floor(size_t n);
+    size_t orderOf(size_t size);
+
+    bool isFree(size_t order, size_t index);
+    void markFree(size_t order, size_t index);
+    void markUsed(size_t order, size_t index);
+
+    bool splitBlock(size_t order, size_t &address);
+    void mergeBuddies(size_t address, size_t order);
     double calculateInternalFragmentation();
 
 public:
@@ -45,6 +92,8 @@ public:
     void printStats();
 
     size_t getTotalMemory() const { return total_memory; }
+    size_t getMinBlockSize() const { return min_block_size; }
+    size_t getMetadataBytes() const;
 };
 
 #endif
@@ -1,30 +1,59 @@
 #ifndef CACHE_H
 #define CACHE_H
 
+#include "replacement.h"
+#include "prefetcher.h"
+#include "latency_stats.h"
+#include "sparse_memory.h"
+#include "miss_classifier.h"
+#include "mshr.h"
+#include "trace.h"
 #include <cstddef>
+#include <cstdint>
 #include <vector>
-#include <list>
-#include <map>
 #include <string>
+#include <utility>
 
 using namespace std;
 
-enum class ReplacementPolicy
+enum class WritePolicy
 {
-    FIFO,
-    LRU,
-    LFU
+    WRITE_THROUGH,
+    WRITE_BACK
 };
 
-struct CacheLine
+enum class WriteMissPolicy
+{
+    NO_WRITE_ALLOCATE,
+    WRITE_ALLOCATE
+};
+
+// How the contents of the levels of a hierarchy relate to each other
+enum class InclusionPolicy
+{
+    NINE,      // non-inclusive non-exclusive: fills every level, no back-invalidation
+    INCLUSIVE, // every line is also in all lower levels; evictions back-invalidate
+    EXCLUSIVE  // a line lives in exactly one level; victims fill the next level
+};
+
+// Small fully associative buffers that can sit beside a cache level and
+// are checked on its misses before the next level
+enum class SideCacheType
+{
+    VICTIM, // holds lines evicted from the level
+    MISS    // holds copies of lines filled into the level
+};
+
+// A line displaced by CacheLevel::insert or removed by CacheLevel::invalidate,
+// with a copy of its block contents
+struct EvictedLine
 {
     bool valid;
-    size_t tag;
-    size_t data;
-    int frequency;
-    int timestamp;
+    bool dirty;
+    size_t address; // first address of the block
+    vector<size_t> data;
 
-    CacheLine() : valid(false), tag(0), data(0), frequency(0), timestamp(0) {}
+    EvictedLine() : valid(false), dirty(false), address(0) {}
 };
 
 class CacheLevel
@@ -35,45 +64,280 @@ private:
     size_t num_sets;
     size_t associativity;
     ReplacementPolicy policy;
+    WritePolicy write_policy;
+    WriteMissPolicy write_miss_policy;
+    uint64_t hit_latency;
 
-    vector<vector<CacheLine>> cache_sets;
-    map<size_t, list<size_t>> lru_lists;
+    // Power-of-two geometries decompose addresses with shifts and masks;
+    // anything else falls back to division
+    bool pow2_geometry;
+    unsigned block_shift;
+    unsigned tag_shift;
+    size_t set_mask;
 
-    int current_time;
-    size_t hits;
-    size_t misses;
+    // Line state is kept structure-of-arrays: way w of set s is entry
+    // s * associativity + w of every array, so a set's tags are contiguous
+    // and can be compared in one pass. Empty ways hold INVALID_TAG.
+    // line_data holds the full block of every line (one word per address),
+    // line l occupying words [l * block_size, (l + 1) * block_size).
+    vector<uint64_t> tags;
+    vector<size_t> line_data;
+    vector<uint8_t> dirty;
+    ReplacementState replacement;
 
-    size_t getSetIndex(size_t address);
-    size_t getTag(size_t address);
+    // Lines brought in by a prefetcher and not yet used by a demand access.
+    // A prefetch becomes ready at cycle ready_cycle; a demand hit issued
+    // before then (current_cycle, kept by the hierarchy) counts as late.
+    vector<uint8_t> prefetched;
+    vector<uint64_t> ready_cycle;
+    uint64_t current_cycle;
+
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t writebacks;
+    uint64_t prefetches_issued;
+    uint64_t prefetches_useful;
+    uint64_t prefetches_late;
+
+    // Optional 3C breakdown of the misses (see MissClassifier)
+    MissClassifier classifier;
+    uint64_t compulsory_misses;
+    uint64_t capacity_misses;
+    uint64_t conflict_misses;
+
+    size_t getSetIndex(size_t address) const;
+    size_t getTag(size_t address) const;
+    size_t getOffset(size_t address) const;
+    void saveLine(size_t line, size_t set_index, EvictedLine *out) const;
+    int findWay(size_t set_index, uint64_t tag) const;
     int findVictim(size_t set_index);
-    void updateLRU(size_t set_index, size_t way);
+    size_t lineAddress(size_t set_index, uint64_t tag) const;
+    bool consumePrefetch(size_t line);
+    void classify(size_t address, bool hit, bool allocate);
 
 public:
-    CacheLevel(size_t size, size_t block_sz, size_t assoc, ReplacementPolicy pol);
+    static const uint64_t INVALID_TAG = ~(uint64_t)0;
+
+    CacheLevel(size_t size, size_t block_sz, size_t assoc, ReplacementPolicy pol,
+               WritePolicy write_pol = WritePolicy::WRITE_THROUGH,
+               WriteMissPolicy miss_pol = WriteMissPolicy::NO_WRITE_ALLOCATE);
 
-    bool access(size_t address, size_t &data);
-    void insert(size_t address, size_t data);
+    // Shared by every hierarchy built from levels: the geometry check (which
+    // reports why a geometry is invalid) and the default hit latency of the
+    // level at `depth` (0 = L1)
+    static bool validGeometry(size_t size, size_t block_sz, size_t assoc);
+    static uint64_t defaultHitLatency(size_t depth);
+
+    // Only demand lookups are classified (see setMissClassification) and
+    // train set dueling
+    bool access(size_t address, size_t &data, bool *prefetch_hit = nullptr, bool demand = true);
+    bool write(size_t address, size_t data, bool *prefetch_hit = nullptr);
+    bool contains(size_t address) const;
+    void markPrefetched(size_t address, uint64_t ready);
+    void setCycle(uint64_t cycle) { current_cycle = cycle; }
+    bool update(size_t address, const size_t *words, size_t count, bool mark_dirty);
+    bool readWords(size_t address, size_t *words, size_t count) const;
+    void insert(size_t address, const size_t *block, bool is_dirty = false, EvictedLine *evicted = nullptr);
+    bool invalidate(size_t address, EvictedLine *removed = nullptr);
     void printStats(const string &level_name);
     double getHitRatio() const;
 
-    size_t getHits() const { return hits; }
-    size_t getMisses() const { return misses; }
+    // Set-partitioned simulation: a shard is a copy of the level with
+    // cleared statistics; mergeShard takes back the sets the shard owned
+    // (those with (set / set_group) % partitions == partition) and adds
+    // its statistics
+    CacheLevel makeShard() const;
+    void mergeShard(const CacheLevel &shard, size_t set_group, size_t partitions, size_t partition);
+    size_t getNumSets() const { return num_sets; }
+    bool isSetLocal() const { return replacement.isSetLocal(); }
+
+    // Bytes of line storage (tags, data and per-line state) a shard copies
+    size_t getFootprint() const
+    {
+        return tags.size() * (2 * sizeof(uint64_t) + 2) + line_data.size() * sizeof(size_t);
+    }
+
+    size_t getBlockSize() const { return block_size; }
+    size_t getAssociativity() const { return associativity; }
+    uint64_t getHitLatency() const { return hit_latency; }
+    void setHitLatency(uint64_t cycles) { hit_latency = cycles; }
+    bool isWriteBack() const { return write_policy == WritePolicy::WRITE_BACK; }
+    bool isWriteAllocate() const { return write_miss_policy == WriteMissPolicy::WRITE_ALLOCATE; }
+
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
+    uint64_t getWritebacks() const { return writebacks; }
+    uint64_t getPrefetchesIssued() const { return prefetches_issued; }
+    uint64_t getPrefetchesUseful() const { return prefetches_useful; }
+    uint64_t getPrefetchesLate() const { return prefetches_late; }
+
+    // Starts (or stops) classifying misses; the breakdown counts the misses
+    // from this point on
+    void setMissClassification(bool enabled);
+    bool isClassifyingMisses() const { return classifier.isEnabled(); }
+    uint64_t getCompulsoryMisses() const { return compulsory_misses; }
+    uint64_t getCapacityMisses() const { return capacity_misses; }
+    uint64_t getConflictMisses() const { return conflict_misses; }
+};
+
+struct SideCache
+{
+    SideCacheType type;
+    CacheLevel *buffer; // nullptr when the level has none
 };
 
+// Reads fill the levels above the one that hit (only the first level for
+// an exclusive hierarchy, where blocks move instead of being copied).
+//
+// A victim cache holds lines evicted from its level: they leave the level
+// for good (written back, victim-filled, back-invalidating) only once they
+// fall out of the victim cache. A miss cache holds clean copies of the
+// lines filled into its level. Either one is probed on a miss at its level
+// and a hit refills the level without going further down.
+//
+// Prefetchers observe the demand accesses reaching their level; the blocks
+// they propose are fetched once the demand access has completed, so a
+// prefetch never reorders the fills of the access that triggered it.
+//
+// Every demand access is charged the hit latency of each level it looks up
+// (plus one cycle per side-cache probe) and the memory latency if it has
+// to read memory or a write reaches it. Writebacks and prefetches are
+// assumed to happen off the critical path.
+//
+// By default every access runs to completion before the next one starts.
+// Giving levels miss status holding registers (MSHRs) switches on a
+// non-blocking timing model on top of that: accesses issue one per cycle
+// and complete after their latency, a miss holds an MSHR of each level it
+// fills until it completes, a miss to a block already in flight merges
+// into its MSHR, and issue stalls while a needed level has every MSHR held
+// or a level without MSHRs is filling.
+//
+// Lines carry whole blocks. Misses fetch the block from the nearest level
+// holding it (or memory), and memory only receives data through dirty
+// writebacks and write-through/no-allocate writes, so the write policies
+// decide both where the current value of an address lives and how much
+// traffic reaches memory (memory_reads / memory_writes). Each level's block
+// size must be a multiple of the one above it.
 class CacheHierarchy
 {
 private:
     vector<CacheLevel *> levels;
-    size_t *main_memory;
+    SparseMemory main_memory;
+    CacheHierarchy *backing; // takes the place of main_memory when set (not owned)
     size_t memory_size;
+    InclusionPolicy inclusion;
+
+    uint64_t memory_reads;
+    uint64_t memory_writes;
+    vector<uint64_t> back_invalidations;
+
+    static const uint64_t SIDE_CACHE_LATENCY = 1;
+    uint64_t memory_latency;
+    uint64_t access_cycles;
+    uint64_t last_access_cycles;
+    LatencyStats latency;
+
+    vector<SideCache> side_caches;
+    vector<Prefetcher *> prefetchers;
+    vector<size_t> prefetch_candidates;
+    vector<pair<size_t, size_t>> pending_prefetches;
+    bool classify_misses;
+
+    // Non-blocking timing, on once any level has MSHRs: the demand lookups
+    // of each access are replayed against the levels' MSHRs after it
+    // completes functionally (see scheduleAccess)
+    struct DemandLookup
+    {
+        size_t level;
+        bool hit;
+        bool fills;    // a miss that brings the block into the level
+        bool merged;   // the block is still in flight (set by scheduleAccess)
+        bool allocate; // needs a new MSHR (set by scheduleAccess)
+    };
+
+    bool non_blocking;
+    vector<MSHRFile> mshrs;
+    vector<DemandLookup> demand_lookups;
+    uint64_t issue_cycle;
+    uint64_t finish_cycle;
+    uint64_t mshr_stall_cycles;
+    uint64_t blocking_stall_cycles;
+    uint64_t timed_accesses;
+
+    // Cycle at which the current access issues, in either timing model
+    // (issue_cycle restarts whenever the MSHRs change)
+    uint64_t clock_cycle;
+
+    vector<size_t> fetch_block;
+    vector<size_t> side_block;
+
+    const size_t *fetchBelow(size_t level, size_t address, bool &was_dirty, bool demand = true,
+                             size_t *deepest = nullptr);
+    void fill(size_t level, size_t address, const size_t *block, bool is_dirty);
+    void evict(size_t level, EvictedLine &line);
+    void backInvalidate(size_t level, EvictedLine &line);
+    bool probeSideCache(size_t level, size_t address, bool &was_dirty);
+    void refreshSideCache(size_t level, size_t address, const size_t *words, size_t count);
+    bool updateLine(size_t level, size_t address, const size_t *words, size_t count, bool mark_dirty);
+    void writeBack(size_t first_level, size_t address, const size_t *words, size_t count);
+    void writeMemory(size_t address, const size_t *words, size_t count);
+    bool uniformBlockSize(size_t block_size) const;
+    void observe(size_t level, size_t address, bool hit, bool prefetch_hit);
+    void issuePrefetches(uint64_t issue);
+    void noteLookup(size_t level, bool hit, bool fills);
+    uint64_t scheduleAccess(size_t address);
+    void startAccess();
+    void finishAccess(size_t address);
+
+    // A shard for set-partitioned replay: copies of the levels with cleared
+    // statistics, over a copy-on-write view of the parent's memory
+    explicit CacheHierarchy(const CacheHierarchy *parent);
+    size_t countPartitions(size_t limit) const;
+    void mergeShards(const vector<CacheHierarchy *> &shards, size_t partitions);
 
 public:
     CacheHierarchy(size_t mem_size);
     ~CacheHierarchy();
 
-    void addLevel(size_t size, size_t block_size, size_t associativity, ReplacementPolicy policy);
+    bool addLevel(size_t size, size_t block_size, size_t associativity, ReplacementPolicy policy,
+                  WritePolicy write_policy = WritePolicy::WRITE_THROUGH,
+                  WriteMissPolicy miss_policy = WriteMissPolicy::NO_WRITE_ALLOCATE);
+    bool setInclusionPolicy(InclusionPolicy policy);
+    bool setSideCache(size_t level, SideCacheType type, size_t entries);
+    bool setPrefetcher(size_t level, PrefetcherType type, size_t degree, size_t distance, size_t latency);
+    bool setHitLatency(size_t level, uint64_t cycles);
+    void setMissClassification(bool enabled);
+    bool setMSHRs(size_t level, size_t entries);
+    static const uint64_t DEFAULT_MEMORY_LATENCY = 100;
+    void setMemoryLatency(uint64_t cycles) { memory_latency = cycles; }
+    uint64_t getLastAccessCycles() const { return last_access_cycles; }
+    const LatencyStats &getLatencyStats() const { return latency; }
+    size_t getNumLevels() const { return levels.size(); }
+    const CacheLevel *getLevel(size_t level) const { return levels[level]; }
+    uint64_t getMemoryReads() const { return memory_reads; }
+    uint64_t getMemoryWrites() const { return memory_writes; }
     size_t read(size_t address);
     void write(size_t address, size_t data);
+
+    // Sends everything that leaves the last level (misses, writebacks and
+    // writes that are not absorbed) to another hierarchy instead of memory,
+    // e.g. a last level shared by several hierarchies. Its access cycles
+    // replace the memory latency. The hierarchy below must have a level
+    // whose block size is a multiple of this one's last level.
+    void setBackingHierarchy(CacheHierarchy *below) { backing = below; }
+
+    // Accesses from a hierarchy above: a demand read of the block holding
+    // `address`, and a dirty block written back
+    void readBlock(size_t address, size_t *words, size_t count);
+    void writeBlock(size_t address, const size_t *words, size_t count);
+
+    // Replays a trace. With more than one thread the sets are partitioned
+    // between threads (see countPartitions) and the result is identical to
+    // a serial replay. Every partition has its own thread and its own copy
+    // of the levels, so there are at most as many as cores and as fit in
+    // MAX_SHARD_BYTES. Returns the number of partitions used, 0 on error.
+    static const size_t MAX_SHARD_BYTES = (size_t)1 << 30;
+    size_t replay(const vector<TraceAccess> &trace, size_t threads = 1);
     void printAllStats();
 };
 
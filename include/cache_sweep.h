@@ -0,0 +1,52 @@
+#ifndef CACHE_SWEEP_H
+#define CACHE_SWEEP_H
+
+#include "cache.h"
+#include "trace.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// One level of a sweep configuration, as passed to CacheHierarchy::addLevel
+struct LevelConfig
+{
+    size_t size;
+    size_t block_size;
+    size_t associativity;
+    ReplacementPolicy policy;
+    WritePolicy write_policy;
+    WriteMissPolicy miss_policy;
+};
+
+// Simulates many hierarchy configurations over the same trace. Every
+// configuration is an independent CacheHierarchy, so worker threads claim
+// configurations from a shared counter and simulate them without further
+// synchronisation; the trace is loaded once and shared read-only.
+class CacheSweep
+{
+private:
+    size_t memory_size;
+    vector<vector<LevelConfig>> configs;
+    vector<CacheHierarchy *> hierarchies;
+
+    CacheHierarchy *build(const vector<LevelConfig> &levels) const;
+    void clearResults();
+
+public:
+    CacheSweep(size_t mem_size);
+    ~CacheSweep();
+
+    bool addConfig(const vector<LevelConfig> &levels);
+    size_t getNumConfigs() const { return configs.size(); }
+
+    // Simulates every configuration on `threads` workers (0: one per core)
+    // and returns the number of workers used
+    size_t run(const vector<TraceAccess> &trace, size_t threads = 0);
+    const CacheHierarchy *getResult(size_t config) const { return hierarchies[config]; }
+    void printResults() const;
+
+    static string describe(const vector<LevelConfig> &levels);
+};
+
+#endif
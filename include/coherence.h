@@ -0,0 +1,162 @@
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include "cache.h"
+#include "sparse_memory.h"
+#include "latency_stats.h"
+#include "trace.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+enum class CoherenceProtocol
+{
+    MESI,
+    MOESI // a modified block read by another core stays dirty in its owner
+};
+
+enum class CoherenceState
+{
+    INVALID,
+    SHARED,
+    EXCLUSIVE,
+    OWNED,
+    MODIFIED
+};
+
+// Per-core traffic on the coherence bus
+struct CoreCoherenceStats
+{
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t read_requests;  // GetS: read miss in every private level
+    uint64_t write_requests; // GetM: write miss in every private level
+    uint64_t upgrades;       // write hit on a shared or owned copy
+    uint64_t invalidations;  // copies this core lost to other cores' writes
+    uint64_t transfers_supplied;
+    uint64_t transfers_received;
+    uint64_t writebacks;     // dirty blocks written to the shared level
+
+    CoreCoherenceStats()
+        : reads(0), writes(0), read_requests(0), write_requests(0), upgrades(0),
+          invalidations(0), transfers_supplied(0), transfers_received(0), writebacks(0) {}
+};
+
+// Cores with private cache levels in front of a shared last-level cache,
+// kept coherent with MESI or MOESI.
+//
+// Each core has the same stack of private levels (L1, L2, ...), inclusive
+// within the core: a block is in a core's caches, with a valid coherence
+// state, exactly when it is in its last private level, and evicting it from
+// there removes it from the levels above. Writes update every private copy
+// of the block, so the last private level always holds the core's current
+// data and only it writes back to the shared level. The shared level is
+// write-back and neither inclusive nor exclusive of the private levels.
+//
+// Coherence is kept by a directory beside the shared level, one entry per
+// block ever accessed, holding its sharers and owner; every private miss
+// and upgrade is one bus transaction that the directory resolves. A
+// modified (or owned) block is supplied by its owner's caches rather than
+// the shared level (a cache-to-cache transfer). Entries also count the
+// invalidations and transfers of their block, and an invalidation counts
+// as false sharing when the core losing its copy never accessed the word
+// being written, which points at unrelated data sharing a block.
+//
+// An access is charged the hit latency of every private level it looks up,
+// the shared level's latency for a bus transaction (wherever the data comes
+// from) and the memory latency when the block has to come from memory.
+//
+// Every level uses the same block size (the coherence granularity).
+class MultiCoreHierarchy
+{
+private:
+    struct DirectoryEntry
+    {
+        uint64_t sharers;           // one bit per core with a valid copy
+        uint64_t accessed_by;       // one bit per core that ever accessed the block
+        int owner;                  // core holding it exclusive, owned or modified; -1 if none
+        CoherenceState owner_state;
+        vector<uint64_t> touched;   // per core, words accessed since its copy arrived
+        uint64_t invalidations;
+        uint64_t false_sharing;
+        uint64_t transfers;
+
+        DirectoryEntry(size_t cores)
+            : sharers(0), accessed_by(0), owner(-1), owner_state(CoherenceState::INVALID),
+              touched(cores, 0), invalidations(0), false_sharing(0), transfers(0) {}
+    };
+
+    size_t num_cores;
+    size_t block_size;
+    CoherenceProtocol protocol;
+    vector<vector<CacheLevel *>> private_levels; // [core][level]
+    CacheLevel *shared_level;
+    SparseMemory main_memory;
+    size_t memory_size;
+    unordered_map<size_t, DirectoryEntry> directory;
+    bool started;
+
+    uint64_t shared_latency; // also the cost of every bus transaction
+    uint64_t memory_latency;
+    uint64_t access_cycles;
+
+    vector<CoreCoherenceStats> core_stats;
+    vector<LatencyStats> core_latency;
+    uint64_t invalidations;
+    uint64_t false_sharing;
+    uint64_t transfers;
+    uint64_t writebacks;
+    uint64_t memory_reads;
+    uint64_t memory_writes;
+
+    vector<size_t> block_buffer;
+
+    bool checkAccess(size_t core, size_t address) const;
+    DirectoryEntry &entryFor(size_t base);
+    uint64_t wordBit(size_t address) const;
+    CoherenceState stateOf(const DirectoryEntry &entry, size_t core) const;
+    int lookupPrivate(size_t core, size_t address);
+    void fillAbove(size_t core, size_t level, size_t base);
+    void fillPrivate(size_t core, size_t base, const size_t *block);
+    void leaveCore(size_t core, EvictedLine &line);
+    void readShared(size_t base, size_t *block);
+    void writeShared(size_t base, const size_t *block);
+    void supply(DirectoryEntry &entry, size_t to_core, size_t base, size_t *block);
+    void invalidateOthers(DirectoryEntry &entry, size_t core, size_t base, uint64_t word);
+
+public:
+    static const size_t MAX_CORES = 64;
+
+    MultiCoreHierarchy(size_t cores, size_t mem_size);
+    ~MultiCoreHierarchy();
+
+    bool addPrivateLevel(size_t size, size_t block_sz, size_t associativity, ReplacementPolicy policy);
+    bool setSharedLevel(size_t size, size_t block_sz, size_t associativity, ReplacementPolicy policy);
+    bool setProtocol(CoherenceProtocol p);
+    CoherenceProtocol getProtocol() const { return protocol; }
+    size_t getNumCores() const { return num_cores; }
+    size_t getNumPrivateLevels() const { return private_levels[0].size(); }
+    bool hasSharedLevel() const { return shared_level != nullptr; }
+    CoherenceState getState(size_t core, size_t address) const;
+
+    // Levels are numbered as in CacheHierarchy: the private levels, then
+    // the shared one. A private level's latency applies to every core.
+    size_t getNumLevels() const { return getNumPrivateLevels() + (hasSharedLevel() ? 1 : 0); }
+    bool setHitLatency(size_t level, uint64_t cycles);
+    void setMemoryLatency(uint64_t cycles) { memory_latency = cycles; }
+
+    // These return false (after reporting why) for an invalid core or
+    // address, or before any private level exists; replay checks the whole
+    // trace before running any of it
+    bool read(size_t core, size_t address, size_t &data);
+    bool write(size_t core, size_t address, size_t data);
+    bool replay(const vector<CoreAccess> &trace);
+
+    void printAllStats();
+    void printHotspots(size_t count);
+};
+
+#endif
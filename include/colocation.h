@@ -0,0 +1,94 @@
+#ifndef COLOCATION_H
+#define COLOCATION_H
+
+#include "cache_sweep.h"
+#include "virtual_memory.h"
+#include "trace.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// How the accesses of co-located threads are merged into one stream
+enum class InterleavePolicy
+{
+    ROUND_ROBIN, // one access per thread in turn
+    WEIGHTED,    // `weight` consecutive accesses per thread in turn
+    TIMESTAMP    // by issue time (timestamped traces), ties to the lower thread
+};
+
+// What one thread saw in one simulation
+struct ThreadRunStats
+{
+    uint64_t accesses;
+    vector<uint64_t> level_hits;
+    vector<uint64_t> level_misses;
+    uint64_t page_faults;
+    uint64_t cycles;
+
+    double getHitRatio(size_t level) const;
+    double getAverageCycles() const;
+};
+
+// Predicts noisy-neighbour effects of running threads together, as if
+// each ran on its own core. Every thread replays its own trace in its own
+// address space, with its own copy of the cache levels above the last one;
+// the interleaved accesses share one VirtualMemory frame pool and the last
+// cache level (a CacheHierarchy backing the private ones), so threads
+// compete for frames and for the last level only.
+//
+// A run simulates the full mix, each thread alone, and the mix without
+// each thread, all from the same deterministic schedule (a subset keeps
+// the relative order of its threads' accesses). What a thread suffers is
+// its shared result against its solo one; what thread i does to thread j
+// is j's result in the full mix against the mix without i. The
+// simulations are independent and run on worker threads.
+class Colocation
+{
+private:
+    struct ThreadTrace
+    {
+        string path;
+        size_t weight;
+        vector<TraceAccess> accesses;
+    };
+
+    size_t virtual_bits;
+    size_t physical_bits;
+    size_t page_size;
+    PageReplacementPolicy page_policy;
+    vector<LevelConfig> levels;
+    vector<ThreadTrace> threads;
+    uint64_t shared_latency; // hit latency of the last level
+
+    // Results of the last run
+    InterleavePolicy interleave;
+    vector<pair<size_t, size_t>> schedule; // (thread, access) in issue order
+    vector<ThreadRunStats> shared;
+    vector<ThreadRunStats> solo;
+    vector<vector<ThreadRunStats>> without; // [left out thread][thread]
+
+    bool loadThreads(InterleavePolicy policy, vector<vector<size_t>> &times);
+    void buildSchedule(InterleavePolicy policy, const vector<vector<size_t>> &times);
+    CacheHierarchy *buildHierarchy(const vector<LevelConfig> &config) const;
+    vector<ThreadRunStats> simulate(uint64_t members) const;
+
+public:
+    static const size_t MAX_THREADS = 64;
+
+    Colocation(size_t virt_bits, size_t phys_bits, size_t page_sz, PageReplacementPolicy policy);
+
+    bool addLevel(const LevelConfig &level);
+    bool addThread(const string &path, size_t weight = 1);
+    size_t getNumThreads() const { return threads.size(); }
+
+    // Loads the traces, interleaves them and runs every simulation on
+    // `workers` threads (0: one per core). Returns false on error.
+    bool run(InterleavePolicy policy, size_t workers = 0);
+    void printResults() const;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef FREE_BLOCK_INDEX_H
+#define FREE_BLOCK_INDEX_H
+
+#include "memory_block.h"
+#include <cstddef>
+#include <map>
+#include <utility>
+
+using namespace std;
+
+// Index over the free blocks of a MemoryAllocator.
+//
+// Free blocks are kept in two structures:
+//   - a treap keyed by address whose nodes carry the largest block size in
+//     their subtree (links live in MemoryBlock), used for first fit
+//   - a map keyed by (size, address), used for best fit and worst fit
+//
+// Ties are broken by lowest address, matching a linear scan of the block list.
+class FreeBlockIndex
+{
+private:
+    MemoryBlock *root;
+    map<pair<size_t, size_t>, MemoryBlock *> by_size;
+    unsigned rng_state;
+
+    unsigned nextPriority();
+    static size_t maxSize(MemoryBlock *node);
+    static void update(MemoryBlock *node);
+    static void split(MemoryBlock *node, size_t address, MemoryBlock *&left, MemoryBlock *&right);
+    static MemoryBlock *merge(MemoryBlock *left, MemoryBlock *right);
+
+public:
+    FreeBlockIndex();
+
+    void insert(MemoryBlock *block);
+    void remove(MemoryBlock *block);
+    void clear();
+
+    MemoryBlock *firstFit(size_t size) const;
+    MemoryBlock *bestFit(size_t size) const;
+    MemoryBlock *worstFit(size_t size) const;
+
+    size_t count() const { return by_size.size(); }
+    size_t largest() const { return by_size.empty() ? 0 : by_size.rbegin()->first.first; }
+};
+
+#endif
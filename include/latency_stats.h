@@ -0,0 +1,36 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+// Simulated cycles of individual accesses: totals for the average access
+// time plus a power-of-two histogram. Bucket 0 holds zero-cycle accesses
+// and bucket b > 0 holds latencies in [2^(b-1), 2^b).
+class LatencyStats
+{
+private:
+    static const size_t NUM_BUCKETS = 48;
+
+    uint64_t accesses;
+    uint64_t total_cycles;
+    uint64_t max_cycles;
+    uint64_t buckets[NUM_BUCKETS];
+
+public:
+    LatencyStats();
+
+    void record(uint64_t cycles);
+    void merge(const LatencyStats &other);
+    void reset();
+    void printHistogram() const;
+
+    uint64_t getAccesses() const { return accesses; }
+    uint64_t getTotalCycles() const { return total_cycles; }
+    uint64_t getMaxCycles() const { return max_cycles; }
+    double getAverage() const;
+};
+
+#endif
@@ -2,6 +2,8 @@
 #define MEMORY_ALLOCATOR_H
 
 #include "memory_block.h"
+#include "free_block_index.h"
+#include "node_pool.h"
 #include <string>
 #include <map>
 
@@ -17,17 +19,20 @@ enum class AllocationStrategy
 class MemoryAllocator
 {
 private:
+    NodePool<MemoryBlock> block_pool;
     MemoryBlock *head;
     size_t total_memory;
     size_t used_memory;
+    size_t requested_memory;
     AllocationStrategy strategy;
     int next_block_id;
     map<int, MemoryBlock *> allocated_blocks;
     map<int, size_t> requested_sizes;
+    FreeBlockIndex free_index;
 
     MemoryBlock *findFreeBlock(size_t size);
     void splitBlock(MemoryBlock *block, size_t size);
-    void coalesceBlocks();
+    MemoryBlock *coalesceBlock(MemoryBlock *block);
     double calculateExternalFragmentation();
     double calculateInternalFragmentation();
 
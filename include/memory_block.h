@@ -15,6 +15,12 @@ public:
     MemoryBlock *next;
     MemoryBlock *prev;
 
+    // Links used by FreeBlockIndex while the block is free
+    MemoryBlock *index_left;
+    MemoryBlock *index_right;
+    unsigned index_priority;
+    size_t index_max_size;
+
     MemoryBlock(size_t addr, size_t sz, bool free = true, int id = -1);
 };
 
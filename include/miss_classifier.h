@@ -0,0 +1,65 @@
+#ifndef MISS_CLASSIFIER_H
+#define MISS_CLASSIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+enum class MissType
+{
+    COMPULSORY, // first reference to the block
+    CAPACITY,   // a fully associative LRU cache of the same size misses too
+    CONFLICT    // only the set mapping made it miss
+};
+
+// Sorts the misses of one cache level into the three Cs. It sees the block
+// number of every demand reference to the level, hit or miss, and runs a
+// shadow fully associative LRU cache with the level's number of lines in
+// lockstep; reference() tells how a miss on the block would be classified.
+//
+// The shadow cache is an intrusive LRU list over `capacity` slots plus a
+// hash table from block number to slot. The same table remembers every
+// block ever referenced (slot NONE once it has left the shadow cache), so a
+// reference costs a single hash lookup. Nothing is ever removed from it, so
+// it is a flat open-addressing table (linear probing, doubled at half
+// load) rather than a node-based map.
+class MissClassifier
+{
+private:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+    static const size_t EMPTY_KEY = ~(size_t)0;
+
+    size_t capacity;
+    size_t used;
+
+    // Hash table entry i maps block keys[i] (EMPTY_KEY if unused) to slot_of[i]
+    vector<size_t> keys;
+    vector<uint32_t> slot_of;
+    size_t entries;
+    unsigned hash_shift;
+
+    vector<size_t> slot_block;
+    vector<uint32_t> next_slot;
+    vector<uint32_t> prev_slot;
+    uint32_t head;
+    uint32_t tail;
+
+    size_t findEntry(size_t block) const;
+    void growTable();
+    void pushFront(uint32_t slot);
+    void unlink(uint32_t slot);
+    uint32_t admit(size_t block);
+
+public:
+    // A classifier with no lines is disabled
+    explicit MissClassifier(size_t lines = 0);
+
+    // A reference that would not allocate on a miss (a no-write-allocate
+    // write) leaves the shadow cache's contents alone
+    MissType reference(size_t block, bool allocate = true);
+    bool isEnabled() const { return capacity > 0; }
+};
+
+#endif
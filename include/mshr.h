@@ -0,0 +1,57 @@
+#ifndef MSHR_H
+#define MSHR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Miss status holding registers of one cache level in the non-blocking
+// timing model. A register tracks one block being fetched into the level
+// from the cycle its miss is issued until the fill completes; a miss to a
+// block still in flight merges into that register instead of fetching the
+// block again. With every register held, a new miss has to wait.
+class MSHRFile
+{
+private:
+    vector<size_t> blocks;
+    vector<uint64_t> ready; // cycle the fill completes; free from then on
+
+    uint64_t primary_misses;
+    uint64_t merged_misses;
+    uint64_t full_stalls;
+    size_t peak_occupancy;
+
+    // Register-cycles held in total, and cycles with at least one held
+    uint64_t occupied_cycles;
+    uint64_t busy_cycles;
+    uint64_t busy_until;
+
+public:
+    // A file with no registers is a blocking cache
+    explicit MSHRFile(size_t entries = 0);
+
+    size_t getEntries() const { return blocks.size(); }
+
+    // Looks for a fill of `block` still in flight at `now`
+    bool findPending(size_t block, uint64_t now, uint64_t &fill_ready) const;
+    // Earliest cycle, not before `now`, at which a register is free
+    uint64_t nextFree(uint64_t now) const;
+    // Holds a register for `block` from `start` until `fill_ready`;
+    // misses must be allocated in order of their start cycle
+    void allocate(size_t block, uint64_t start, uint64_t fill_ready);
+    void recordMerge() { merged_misses++; }
+    void recordFullStall() { full_stalls++; }
+
+    uint64_t getPrimaryMisses() const { return primary_misses; }
+    uint64_t getMergedMisses() const { return merged_misses; }
+    uint64_t getFullStalls() const { return full_stalls; }
+    size_t getPeakOccupancy() const { return peak_occupancy; }
+    uint64_t getOccupiedCycles() const { return occupied_cycles; }
+
+    // Average number of misses in flight while any is
+    double getParallelism() const;
+};
+
+#endif
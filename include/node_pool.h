@@ -0,0 +1,95 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Slab allocator for fixed-size bookkeeping nodes.
+//
+// Nodes are carved out of contiguous slabs and recycled through an intrusive
+// free list, so splitting and merging blocks never reaches the system malloc
+// once the pool has grown to the working-set size. Slabs are released only
+// when the pool is destroyed.
+template <typename T>
+class NodePool
+{
+private:
+    union Slot
+    {
+        Slot *next_free;
+        typename aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    static const size_t MIN_SLAB_NODES = 64;
+    static const size_t MAX_SLAB_NODES = 4096;
+
+    vector<Slot *> slabs;
+    Slot *free_list;
+    size_t next_slab_nodes;
+    size_t live_nodes;
+
+    void grow()
+    {
+        Slot *slab = new Slot[next_slab_nodes];
+        slabs.push_back(slab);
+
+        for (size_t i = next_slab_nodes; i > 0; i--)
+        {
+            slab[i - 1].next_free = free_list;
+            free_list = &slab[i - 1];
+        }
+
+        if (next_slab_nodes < MAX_SLAB_NODES)
+        {
+            next_slab_nodes *= 2;
+        }
+    }
+
+public:
+    NodePool() : free_list(nullptr), next_slab_nodes(MIN_SLAB_NODES), live_nodes(0) {}
+
+    ~NodePool()
+    {
+        for (Slot *slab : slabs)
+        {
+            delete[] slab;
+        }
+    }
+
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    template <typename... Args>
+    T *create(Args &&...args)
+    {
+        if (free_list == nullptr)
+        {
+            grow();
+        }
+
+        Slot *slot = free_list;
+        free_list = slot->next_free;
+        live_nodes++;
+
+        return new (&slot->storage) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T *node)
+    {
+        node->~T();
+
+        Slot *slot = reinterpret_cast<Slot *>(node);
+        slot->next_free = free_list;
+        free_list = slot;
+        live_nodes--;
+    }
+
+    size_t liveNodes() const { return live_nodes; }
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+enum class PrefetcherType
+{
+    NEXT_LINE,
+    STRIDE,
+    STREAM
+};
+
+// Hardware prefetcher attached to one cache level. It watches the demand
+// accesses reaching that level as block numbers (address / block_size) and
+// proposes blocks to bring in; the hierarchy drops candidates that are
+// already cached or out of range.
+//
+// Every prefetcher issues `degree` blocks per trigger, starting `distance`
+// blocks ahead of the triggering access:
+// - next-line: on a miss or the first hit to a prefetched line, the blocks
+//   following the accessed one
+// - stride: a PC-less detector on the address stream; once the same block
+//   stride is seen twice in a row, it prefetches along that stride
+// - stream: a small table of stream buffers, each following one ascending
+//   or descending run of misses; a miss close behind a tracked stream
+//   confirms its direction and advances it
+class Prefetcher
+{
+private:
+    static const size_t NUM_STREAMS = 8;
+
+    struct Stream
+    {
+        bool valid;
+        size_t last_block;
+        int direction; // 0 until a second miss sets it
+        uint64_t last_use;
+    };
+
+    PrefetcherType type;
+    size_t degree;
+    size_t distance;
+    size_t latency;
+
+    // Stride detector state
+    bool has_last;
+    size_t last_block;
+    long long last_stride;
+    unsigned confidence;
+
+    vector<Stream> streams;
+    uint64_t stream_clock;
+
+    void issueAlong(size_t block, long long stride, vector<size_t> &candidates) const;
+    void trainStride(size_t block, vector<size_t> &candidates);
+    void trainStream(size_t block, vector<size_t> &candidates);
+
+public:
+    Prefetcher(PrefetcherType t, size_t deg, size_t dist, size_t lat);
+
+    // Observe a demand access; `trigger` is true for a miss or the first
+    // hit to a prefetched line. Candidate block numbers are appended.
+    void observe(size_t block, bool trigger, vector<size_t> &candidates);
+
+    PrefetcherType getType() const { return type; }
+    size_t getDegree() const { return degree; }
+    size_t getDistance() const { return distance; }
+    size_t getLatency() const { return latency; }
+    const char *getName() const;
+};
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef REPLACEMENT_H
+#define REPLACEMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum class ReplacementPolicy
+{
+    FIFO,
+    LRU,
+    LFU,
+    SRRIP, // static re-reference interval prediction
+    BRRIP, // bimodal RRIP: most insertions predicted distant
+    DRRIP, // SRRIP or BRRIP, chosen by set dueling
+    ARC,   // adaptive replacement cache
+    TWO_Q  // 2Q: FIFO probation queue, LRU main queue
+};
+
+// The policies' command names (fifo, lru, ..., 2q), kept in one table;
+// replacementPolicyFromName returns false for an unknown name
+const char *replacementPolicyName(ReplacementPolicy policy);
+bool replacementPolicyFromName(const string &name, ReplacementPolicy &policy);
+
+// Replacement metadata for every set of one cache level, with O(1) updates
+// on hits.
+//
+// LRU and FIFO keep an intrusive recency list per set (head = most recent
+// insertion or use, tail = victim); FIFO simply never moves a line on a hit.
+// LFU keeps per-set frequency buckets in ascending order, each holding its
+// lines from least to most recently used, so the victim is the least
+// recently used line among those with the lowest frequency.
+//
+// The RRIP policies keep a 2-bit re-reference prediction value (RRPV) per
+// line: hits predict a near re-reference (0), the victim is the first line
+// predicted distant (RRPV 3), ageing the set until one is. SRRIP inserts at
+// 2; BRRIP inserts at 3 except for every 32nd fill of a set. DRRIP dedicates
+// leader sets to each and lets a saturating counter (PSEL), moved by the
+// leaders' demand misses, pick the policy of all other sets.
+//
+// ARC and 2Q split each set into two recency lists and remember the tags
+// of some evicted lines (ghosts). ARC keeps lines seen once (T1) apart from
+// lines seen again (T2) and adapts its target size for T1 on ghost hits.
+// 2Q fills new lines into a FIFO probation queue (A1in, a quarter of the
+// set); lines evicted from it are remembered (A1out), and refetching one of
+// them promotes it to the LRU main queue (Am).
+//
+// Ways, bucket slots and ghosts are numbered within their set; all arrays
+// are flat and indexed by set * associativity + slot (per-set arrays by set).
+class ReplacementState
+{
+private:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    static const uint8_t RRPV_MAX = 3;
+    static const size_t BRRIP_LONG_INTERVAL = 32;
+    static const uint32_t PSEL_MAX = 1023;
+
+    ReplacementPolicy policy;
+    size_t num_sets;
+    size_t associativity;
+
+    // Recency lists: one per set, two for ARC (T1, T2) and 2Q (A1in, Am),
+    // with list_head/list_tail/list_size indexed by set * num_lists + list
+    size_t num_lists;
+    vector<uint32_t> next_way;
+    vector<uint32_t> prev_way;
+    vector<uint32_t> list_head;
+    vector<uint32_t> list_tail;
+    vector<uint32_t> list_size;
+    vector<uint8_t> line_list;
+
+    vector<uint64_t> bucket_freq;
+    vector<uint32_t> bucket_first;
+    vector<uint32_t> bucket_last;
+    vector<uint32_t> bucket_next;
+    vector<uint32_t> bucket_prev;
+    vector<uint32_t> bucket_head;
+    vector<uint32_t> bucket_free;
+    vector<uint32_t> line_bucket;
+
+    vector<uint8_t> rrpv;
+    vector<uint8_t> fill_count;
+    uint32_t psel;
+
+    // DRRIP: 0 for an SRRIP leader set, 1 for a BRRIP leader, 2 for a
+    // follower, looked up rather than computed on every fill
+    vector<uint8_t> dueling_role;
+
+    // Ghost lists, oldest first: ARC's B1 and B2, 2Q's A1out. Each set has
+    // room for associativity tags per list, with ghost_tags indexed by
+    // (set * num_ghost_lists + list) * associativity + position
+    size_t num_ghost_lists;
+    vector<uint64_t> ghost_tags;
+    vector<uint32_t> ghost_count;
+    vector<uint32_t> arc_target;
+
+    // Which list the block being inserted goes to, decided by prepareInsert
+    uint8_t insert_list;
+    bool incoming_from_b2;
+
+    void pushFront(size_t set, uint32_t way, uint8_t list = 0);
+    void unlink(size_t set, uint32_t way);
+    uint32_t listSize(size_t set, uint8_t list) const { return list_size[set * num_lists + list]; }
+
+    bool findGhost(size_t set, size_t list, uint64_t tag, size_t &position) const;
+    void removeGhost(size_t set, size_t list, size_t position);
+    void addGhost(size_t set, size_t list, uint64_t tag, size_t limit);
+    void trimGhosts(size_t set, size_t list, size_t limit);
+
+    void trainDueling(size_t set);
+    bool usesBrrip(size_t set) const;
+
+    uint32_t allocBucket(size_t set, uint64_t freq, uint32_t after);
+    void releaseBucket(size_t set, uint32_t bucket);
+    void appendToBucket(size_t set, uint32_t bucket, uint32_t way);
+    void removeFromBucket(size_t set, uint32_t way);
+
+public:
+    ReplacementState(ReplacementPolicy pol, size_t num_sets, size_t assoc);
+
+    void onHit(size_t set, size_t way);
+
+    // A demand miss in the set (not a prefetch, writeback or victim fill)
+    void onMiss(size_t set)
+    {
+        if (policy == ReplacementPolicy::DRRIP)
+        {
+            trainDueling(set);
+        }
+    }
+
+    // A fill calls prepareInsert with the incoming tag, then victim if the
+    // set is full, onEvict for a displaced line and finally onInsert.
+    // onRemove drops a line that was invalidated rather than replaced.
+    void prepareInsert(size_t set, uint64_t tag);
+    size_t victim(size_t set);
+    void onEvict(size_t set, size_t way, uint64_t tag);
+    void onInsert(size_t set, size_t way);
+    void onRemove(size_t set, size_t way);
+
+    // True when all sets are independent (no state shared between sets)
+    bool isSetLocal() const { return policy != ReplacementPolicy::DRRIP; }
+
+    // Copies the state of one set from another instance with the same geometry
+    void copySet(const ReplacementState &from, size_t set);
+};
+
+#endif
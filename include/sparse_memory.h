@@ -0,0 +1,56 @@
+#ifndef SPARSE_MEMORY_H
+#define SPARSE_MEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Word-per-address backing store that only allocates the pages it is
+// written to. Untouched addresses read as zero without allocating, so
+// simulating a large physical memory costs nothing up front and memory use
+// tracks the written footprint.
+class SparseMemory
+{
+private:
+    static const size_t PAGE_SHIFT = 12;
+    static const size_t PAGE_WORDS = (size_t)1 << PAGE_SHIFT;
+
+    unordered_map<size_t, unique_ptr<size_t[]>> pages;
+
+    // Copy-on-write parent of a shard (see SparseMemory(const SparseMemory *))
+    const SparseMemory *base;
+
+    // Most recently used page, to skip the hash lookup on nearby accesses
+    mutable size_t last_page_number;
+    mutable size_t *last_page;
+
+    size_t *findOwnPage(size_t page_number) const;
+    const size_t *findPage(size_t page_number) const;
+    size_t *touchPage(size_t page_number);
+
+public:
+    SparseMemory();
+
+    // A shard reads through to `base` and copies a page on its first write
+    // to it; base must not change while the shard is in use. Shards of the
+    // same base may be used from different threads.
+    explicit SparseMemory(const SparseMemory *base);
+
+    // Applies the writes of shards of this memory. Each word may have been
+    // changed by at most one shard.
+    void mergeShards(const vector<const SparseMemory *> &shards);
+
+    size_t read(size_t address) const;
+    void write(size_t address, size_t value);
+    void readBlock(size_t address, size_t *words, size_t count) const;
+    void writeBlock(size_t address, const size_t *words, size_t count);
+
+    size_t getPagesTouched() const { return pages.size(); }
+    size_t getBytesAllocated() const { return pages.size() * PAGE_WORDS * sizeof(size_t); }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef STACK_DISTANCE_H
+#define STACK_DISTANCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Mattson stack-distance analysis for LRU caches. The stack distance of an
+// access is the number of distinct blocks of its set touched since the
+// previous access to the same block; an A-way LRU set misses exactly on the
+// accesses whose distance is at least A (and on first touches). One pass
+// over a trace therefore gives the miss ratio of every associativity for a
+// geometry with `num_sets` sets (the CacheLevel set mapping), and with one
+// set the miss ratio of every fully associative size.
+class StackDistanceAnalyzer
+{
+private:
+    // Fenwick tree over one set's access times, holding a 1 at the latest
+    // access of each block: the distance of a reuse is the number of ones
+    // after the block's previous access. It doubles as the set's trace grows.
+    struct ReuseCounter
+    {
+        vector<uint64_t> tree;
+        size_t time;
+        uint64_t live;
+
+        ReuseCounter() : tree(2, 0), time(0), live(0) {}
+
+        size_t tick();
+        void add(size_t index, int64_t delta);
+        uint64_t prefix(size_t index) const;
+    };
+
+    size_t block_size;
+    size_t num_sets;
+
+    vector<ReuseCounter> sets;
+    unordered_map<size_t, size_t> last_access;
+
+    uint64_t accesses;
+    uint64_t cold_misses;
+    vector<uint64_t> distances;
+
+public:
+    StackDistanceAnalyzer(size_t block_size, size_t num_sets = 1);
+
+    void access(size_t address);
+
+    size_t getBlockSize() const { return block_size; }
+    size_t getNumSets() const { return num_sets; }
+    uint64_t getAccesses() const { return accesses; }
+    uint64_t getColdMisses() const { return cold_misses; }
+    uint64_t getMisses(size_t ways) const;
+    double getMissRatio(size_t ways) const;
+
+    // Miss ratio at power-of-two associativities, up to the point where
+    // only cold misses are left
+    void printCurve() const;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct TraceAccess
+{
+    size_t address;
+    bool is_write;
+    size_t data;
+};
+
+// Memory traces hold one access per line: "R <address>", "W <address>
+// [data]" or a bare address (a read). Addresses may be decimal or 0x hex;
+// blank lines and lines starting with # are skipped. Writes without data
+// store the line number, so every write is distinguishable.
+bool loadTrace(const string &path, vector<TraceAccess> &trace);
+
+// A trace access tagged with the core that issues it
+struct CoreAccess
+{
+    size_t core;
+    TraceAccess access;
+};
+
+// Multi-core traces prefix every access with the issuing core:
+// "<core> R <address>", "<core> W <address> [data]" or "<core> <address>"
+bool loadCoreTrace(const string &path, vector<CoreAccess> &trace);
+
+// A trace access with the time it is issued
+struct TimedAccess
+{
+    size_t time;
+    TraceAccess access;
+};
+
+// Timestamped traces prefix every access with its issue time, in any unit
+// and never decreasing: "<time> R <address>", "<time> W <address> [data]"
+// or "<time> <address>"
+bool loadTimedTrace(const string &path, vector<TimedAccess> &trace);
+
+#endif
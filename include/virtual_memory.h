@@ -2,6 +2,7 @@
 #define VIRTUAL_MEMORY_H
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <queue>
 #include <map>
@@ -21,8 +22,8 @@ struct PageTableEntry
     size_t frame_number;
     bool dirty;          
     bool reference;      
-    int timestamp;       
-    int load_time;       
+    uint64_t timestamp; // last access, in translations
+    uint64_t load_time;
 
     PageTableEntry() : valid(false), frame_number(0), dirty(false),
                        reference(false), timestamp(0), load_time(0) {}
@@ -37,36 +38,55 @@ private:
     size_t num_virtual_pages;
     size_t num_physical_frames;
 
+    // Address spaces share the frames; page p of space s is page table
+    // entry s * num_virtual_pages + p
+    size_t address_spaces;
+    bool verbose;
+
+    // Power-of-two pages split addresses with a shift and mask
+    bool pow2_pages;
+    unsigned page_shift;
+    size_t offset_mask;
+
     vector<PageTableEntry> page_table;
     vector<bool> frame_allocation; 
     vector<size_t> frame_to_page; 
 
     PageReplacementPolicy policy;
     queue<size_t> fifo_queue;
-    int clock_hand;
-    int current_time;
+    size_t clock_hand;
+    uint64_t current_time;
+
+    uint64_t page_faults;
+    uint64_t page_hits;
 
-    size_t page_faults;
-    size_t page_hits;
+    // Page-fault service time; translations that hit cost nothing (TLB hit)
+    uint64_t fault_latency;
+    uint64_t fault_cycles;
+    uint64_t last_translation_cycles;
 
     size_t getPageNumber(size_t virtual_address);
     size_t getOffset(size_t virtual_address);
-    int findFreeFrame();
-    int selectVictimPage();
+    bool findFreeFrame(size_t &frame);
+    bool selectVictimPage(size_t &page);
     void loadPage(size_t page_number, size_t frame_number);
     void evictPage(size_t frame_number);
 
 public:
+    // `verbose` reports initialization, page faults, evictions and loads
     VirtualMemory(size_t virtual_bits, size_t physical_bits,
-                  size_t page_sz, PageReplacementPolicy pol);
+                  size_t page_sz, PageReplacementPolicy pol,
+                  size_t spaces = 1, bool verbose = true);
 
-    size_t translate(size_t virtual_address);
+    size_t translate(size_t virtual_address, size_t space = 0);
     void accessPage(size_t virtual_address);
     void printStats();
     void printPageTable();
 
-    size_t getPageFaults() const { return page_faults; }
-    size_t getPageHits() const { return page_hits; }
+    uint64_t getPageFaults() const { return page_faults; }
+    uint64_t getPageHits() const { return page_hits; }
+    void setFaultLatency(uint64_t cycles) { fault_latency = cycles; }
+    uint64_t getLastTranslationCycles() const { return last_translation_cycles; }
     double getHitRatio() const;
 };
 
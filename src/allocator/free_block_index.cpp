@@ -0,0 +1,152 @@
+#include "../../include/free_block_index.h"
+#include <algorithm>
+
+using namespace std;
+
+FreeBlockIndex::FreeBlockIndex()
+    : root(nullptr), rng_state(2463534242u)
+{
+}
+
+unsigned FreeBlockIndex::nextPriority()
+{
+    // xorshift32 keeps priorities deterministic between runs
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+size_t FreeBlockIndex::maxSize(MemoryBlock *node)
+{
+    return node != nullptr ? node->index_max_size : 0;
+}
+
+void FreeBlockIndex::update(MemoryBlock *node)
+{
+    node->index_max_size = max(node->size,
+                               max(maxSize(node->index_left), maxSize(node->index_right)));
+}
+
+void FreeBlockIndex::split(MemoryBlock *node, size_t address,
+                           MemoryBlock *&left, MemoryBlock *&right)
+{
+    // left receives blocks below address, right the rest
+    if (node == nullptr)
+    {
+        left = right = nullptr;
+        return;
+    }
+
+    if (node->address < address)
+    {
+        split(node->index_right, address, node->index_right, right);
+        left = node;
+    }
+    else
+    {
+        split(node->index_left, address, left, node->index_left);
+        right = node;
+    }
+    update(node);
+}
+
+MemoryBlock *FreeBlockIndex::merge(MemoryBlock *left, MemoryBlock *right)
+{
+    if (left == nullptr)
+        return right;
+    if (right == nullptr)
+        return left;
+
+    if (left->index_priority > right->index_priority)
+    {
+        left->index_right = merge(left->index_right, right);
+        update(left);
+        return left;
+    }
+
+    right->index_left = merge(left, right->index_left);
+    update(right);
+    return right;
+}
+
+void FreeBlockIndex::insert(MemoryBlock *block)
+{
+    block->index_left = nullptr;
+    block->index_right = nullptr;
+    block->index_priority = nextPriority();
+    block->index_max_size = block->size;
+
+    MemoryBlock *left;
+    MemoryBlock *right;
+    split(root, block->address, left, right);
+    root = merge(merge(left, block), right);
+
+    by_size[make_pair(block->size, block->address)] = block;
+}
+
+void FreeBlockIndex::remove(MemoryBlock *block)
+{
+    MemoryBlock *left;
+    MemoryBlock *middle;
+    MemoryBlock *right;
+    split(root, block->address, left, right);
+    split(right, block->address + 1, middle, right);
+    root = merge(left, right);
+
+    block->index_left = nullptr;
+    block->index_right = nullptr;
+
+    by_size.erase(make_pair(block->size, block->address));
+}
+
+void FreeBlockIndex::clear()
+{
+    root = nullptr;
+    by_size.clear();
+}
+
+MemoryBlock *FreeBlockIndex::firstFit(size_t size) const
+{
+    MemoryBlock *node = root;
+
+    if (maxSize(node) < size)
+        return nullptr;
+
+    // Descend towards the lowest address whose subtree can hold the request
+    while (node != nullptr)
+    {
+        if (maxSize(node->index_left) >= size)
+        {
+            node = node->index_left;
+        }
+        else if (node->size >= size)
+        {
+            return node;
+        }
+        else
+        {
+            node = node->index_right;
+        }
+    }
+
+    return nullptr;
+}
+
+MemoryBlock *FreeBlockIndex::bestFit(size_t size) const
+{
+    auto it = by_size.lower_bound(make_pair(size, (size_t)0));
+    return it != by_size.end() ? it->second : nullptr;
+}
+
+MemoryBlock *FreeBlockIndex::worstFit(size_t size) const
+{
+    if (by_size.empty())
+        return nullptr;
+
+    size_t largest = by_size.rbegin()->first.first;
+    if (largest < size)
+        return nullptr;
+
+    return by_size.lower_bound(make_pair(largest, (size_t)0))->second;
+}
@@ -7,10 +7,11 @@
 using namespace std;
 
 MemoryAllocator::MemoryAllocator(size_t memory_size)
-    : total_memory(memory_size), used_memory(0),
+    : total_memory(memory_size), used_memory(0), requested_memory(0),
       strategy(AllocationStrategy::FIRST_FIT), next_block_id(1)
 {
-    head = new MemoryBlock(0, memory_size, true, -1);
+    head = block_pool.create(0, memory_size, true, -1);
+    free_index.insert(head);
 }
 
 MemoryAllocator::~MemoryAllocator()
@@ -19,7 +20,7 @@ MemoryAllocator::~MemoryAllocator()
     while (current != nullptr)
     {
         MemoryBlock *next = current->next;
-        delete current;
+        block_pool.destroy(current);
         current = next;
     }
 }
@@ -31,44 +32,16 @@ void MemoryAllocator::setStrategy(AllocationStrategy strat)
 
 MemoryBlock *MemoryAllocator::findFreeBlock(size_t size)
 {
-    MemoryBlock *current = head;
-    MemoryBlock *best_fit = nullptr;
-    MemoryBlock *worst_fit = nullptr;
-
-    while (current != nullptr)
+    switch (strategy)
     {
-        if (current->is_free && current->size >= size)
-        {
-            switch (strategy)
-            {
-            case AllocationStrategy::FIRST_FIT:
-                return current;
-
-            case AllocationStrategy::BEST_FIT:
-                if (best_fit == nullptr || current->size < best_fit->size)
-                {
-                    best_fit = current;
-                }
-                break;
-
-            case AllocationStrategy::WORST_FIT:
-                if (worst_fit == nullptr || current->size > worst_fit->size)
-                {
-                    worst_fit = current;
-                }
-                break;
-            }
-        }
-        current = current->next;
-    }
+    case AllocationStrategy::FIRST_FIT:
+        return free_index.firstFit(size);
 
-    if (strategy == AllocationStrategy::BEST_FIT)
-    {
-        return best_fit;
-    }
-    else if (strategy == AllocationStrategy::WORST_FIT)
-    {
-        return worst_fit;
+    case AllocationStrategy::BEST_FIT:
+        return free_index.bestFit(size);
+
+    case AllocationStrategy::WORST_FIT:
+        return free_index.worstFit(size);
     }
 
     return nullptr;
@@ -79,7 +52,7 @@ void MemoryAllocator::splitBlock(MemoryBlock *block, size_t size)
     if (block->size > size)
     {
         // Create a new free block for the remaining space
-        MemoryBlock *new_block = new MemoryBlock(
+        MemoryBlock *new_block = block_pool.create(
             block->address + size,
             block->size - size,
             true,
@@ -95,34 +68,46 @@ void MemoryAllocator::splitBlock(MemoryBlock *block, size_t size)
 
         block->next = new_block;
         block->size = size;
+
+        free_index.insert(new_block);
     }
 }
 
-void MemoryAllocator::coalesceBlocks()
+MemoryBlock *MemoryAllocator::coalesceBlock(MemoryBlock *block)
 {
-    MemoryBlock *current = head;
-
-    while (current != nullptr && current->next != nullptr)
+    // Free blocks are never left adjacent, so only the direct neighbors can merge
+    MemoryBlock *next = block->next;
+    if (next != nullptr && next->is_free)
     {
-        if (current->is_free && current->next->is_free)
+        free_index.remove(next);
+        block->size += next->size;
+        block->next = next->next;
+
+        if (next->next != nullptr)
         {
-            // Merge with next block
-            MemoryBlock *next = current->next;
-            current->size += next->size;
-            current->next = next->next;
+            next->next->prev = block;
+        }
 
-            if (next->next != nullptr)
-            {
-                next->next->prev = current;
-            }
+        block_pool.destroy(next);
+    }
 
-            delete next;
-        }
-        else
+    MemoryBlock *prev = block->prev;
+    if (prev != nullptr && prev->is_free)
+    {
+        free_index.remove(prev);
+        prev->size += block->size;
+        prev->next = block->next;
+
+        if (block->next != nullptr)
         {
-            current = current->next;
+            block->next->prev = prev;
         }
+
+        block_pool.destroy(block);
+        block = prev;
     }
+
+    return block;
 }
 
 int MemoryAllocator::malloc(size_t size)
@@ -141,6 +126,7 @@ int MemoryAllocator::malloc(size_t size)
         return -1;
     }
 
+    free_index.remove(block);
     splitBlock(block, size);
 
     block->is_free = false;
@@ -148,6 +134,7 @@ int MemoryAllocator::malloc(size_t size)
     allocated_blocks[block->block_id] = block;
     requested_sizes[block->block_id] = size;
     used_memory += block->size;
+    requested_memory += size;
 
     cout << "Allocated block id=" << block->block_id
          << " at address=0x" << hex << setfill('0')
@@ -170,10 +157,12 @@ bool MemoryAllocator::free(int block_id)
     block->is_free = true;
     block->block_id = -1;
     used_memory -= block->size;
+    requested_memory -= requested_sizes[block_id];
     allocated_blocks.erase(it);
     requested_sizes.erase(block_id);
 
-    coalesceBlocks();
+    block = coalesceBlock(block);
+    free_index.insert(block);
 
     cout << "Block " << block_id << " freed and merged" << endl;
     return true;
@@ -207,19 +196,8 @@ void MemoryAllocator::dumpMemory()
 
 double MemoryAllocator::calculateExternalFragmentation()
 {
-    size_t total_free = 0;
-    size_t largest_free = 0;
-
-    MemoryBlock *current = head;
-    while (current != nullptr)
-    {
-        if (current->is_free)
-        {
-            total_free += current->size;
-            largest_free = max(largest_free, current->size);
-        }
-        current = current->next;
-    }
+    size_t total_free = total_memory - used_memory;
+    size_t largest_free = free_index.largest();
 
     if (total_free == 0)
         return 0.0;
@@ -230,27 +208,11 @@ double MemoryAllocator::calculateExternalFragmentation()
 double MemoryAllocator::calculateInternalFragmentation()
 {
     // Internal fragmentation occurs when allocated block is larger than requested
-    if (allocated_blocks.empty())
+    if (used_memory == 0)
         return 0.0;
 
-    size_t total_allocated = 0;
-    size_t total_wasted = 0;
-
-    for (const auto &pair : allocated_blocks)
-    {
-        int block_id = pair.first;
-        MemoryBlock *block = pair.second;
-        size_t requested = requested_sizes[block_id];
-        size_t allocated = block->size;
-
-        total_allocated += allocated;
-        total_wasted += (allocated - requested);
-    }
-
-    if (total_allocated == 0)
-        return 0.0;
-
-    return (double)total_wasted / total_allocated * 100.0;
+    size_t total_wasted = used_memory - requested_memory;
+    return (double)total_wasted / used_memory * 100.0;
 }
 
 void MemoryAllocator::printStats()
@@ -263,15 +225,7 @@ void MemoryAllocator::printStats()
     cout << "External fragmentation: " << fixed << setprecision(2) << calculateExternalFragmentation() << "%" << endl;
     cout << "Internal fragmentation: " << fixed << setprecision(2) << calculateInternalFragmentation() << "%" << endl;
 
-    int free_blocks = 0;
-    MemoryBlock *current = head;
-    while (current != nullptr)
-    {
-        if (current->is_free)
-            free_blocks++;
-        current = current->next;
-    }
-    cout << "Number of free blocks: " << free_blocks << endl;
+    cout << "Number of free blocks: " << free_index.count() << endl;
     cout << "Number of allocated blocks: " << allocated_blocks.size() << endl;
     cout << endl;
 }
@@ -3,6 +3,7 @@
 using namespace std;
 
 MemoryBlock::MemoryBlock(size_t addr, size_t sz, bool free, int id)
-    : address(addr), size(sz), is_free(free), block_id(id), next(nullptr), prev(nullptr)
+    : address(addr), size(sz), is_free(free), block_id(id), next(nullptr), prev(nullptr),
+      index_left(nullptr), index_right(nullptr), index_priority(0), index_max_size(sz)
 {
 }
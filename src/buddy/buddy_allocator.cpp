@@ -6,8 +6,70 @@
 
 using namespace std;
 
+void BuddyBitmap::init(size_t bits)
+{
+    levels.clear();
+
+    size_t words = (bits + 63) / 64;
+    levels.push_back(vector<uint64_t>(words, 0));
+
+    while (words > 1)
+    {
+        words = (words + 63) / 64;
+        levels.push_back(vector<uint64_t>(words, 0));
+    }
+}
+
+void BuddyBitmap::set(size_t index)
+{
+    for (size_t level = 0; level < levels.size(); level++)
+    {
+        uint64_t &word = levels[level][index / 64];
+        bool was_empty = word == 0;
+        word |= (uint64_t)1 << (index % 64);
+
+        if (!was_empty)
+            break;
+        index /= 64;
+    }
+}
+
+void BuddyBitmap::clear(size_t index)
+{
+    for (size_t level = 0; level < levels.size(); level++)
+    {
+        uint64_t &word = levels[level][index / 64];
+        word &= ~((uint64_t)1 << (index % 64));
+
+        if (word != 0)
+            break;
+        index /= 64;
+    }
+}
+
+size_t BuddyBitmap::findFirst() const
+{
+    size_t index = 0;
+    for (size_t level = levels.size(); level > 0; level--)
+    {
+        index = index * 64 + __builtin_ctzll(levels[level - 1][index]);
+    }
+    return index;
+}
+
+size_t BuddyBitmap::bytes() const
+{
+    size_t total = 0;
+    for (const auto &level : levels)
+    {
+        total += level.size() * sizeof(uint64_t);
+    }
+    return total;
+}
+
 BuddyAllocator::BuddyAllocator(size_t memory_size, size_t min_size)
-    : min_block_size(min_size), next_block_id(1)
+    : min_block_size(min_size), nonempty_orders(0), next_block_id(1), used_memory(0),
+      requested_memory(0), free_block_count(0)
 {
 
     // Ensure memory size is power of 2
@@ -20,24 +82,35 @@ BuddyAllocator::BuddyAllocator(size_t memory_size, size_t min_size)
 
     total_memory = memory_size;
 
-    // Initialize free list with one large block
-    BuddyBlock *initial_block = new BuddyBlock(0, total_memory, true);
-    free_lists[total_memory].push_back(initial_block);
+    if (!isPowerOf2(min_block_size))
+    {
+        min_block_size = roundUpToPowerOf2(min_block_size);
+    }
+    if (min_block_size > total_memory)
+    {
+        min_block_size = total_memory;
+    }
+
+    min_block_shift = log2Floor(min_block_size);
+    max_order = log2Floor(total_memory) - min_block_shift;
+
+    // One bit per aligned block of each order
+    free_bitmaps.resize(max_order + 1);
+    for (size_t order = 0; order <= max_order; order++)
+    {
+        free_bitmaps[order].init((size_t)1 << (max_order - order));
+    }
+    free_counts.assign(max_order + 1, 0);
+
+    // Initially the whole memory is a single free block
+    markFree(max_order, 0);
 }
 
 BuddyAllocator::~BuddyAllocator()
 {
-    // Clean up all blocks
-    for (auto &pair : free_lists)
-    {
-        for (auto block : pair.second)
-        {
-            delete block;
-        }
-    }
     for (auto &pair : allocated_blocks)
     {
-        delete pair.second;
+        block_pool.destroy(pair.second);
     }
 }
 
@@ -63,100 +136,77 @@ size_t BuddyAllocator::roundUpToPowerOf2(size_t size)
     return size;
 }
 
-size_t BuddyAllocator::getBuddyAddress(size_t address, size_t size)
+size_t BuddyAllocator::log2Floor(size_t n)
 {
-    return address ^ size;
+    return 63 - __builtin_clzll(n);
 }
 
-BuddyBlock *BuddyAllocator::splitBlock(size_t size)
+size_t BuddyAllocator::orderOf(size_t size)
 {
-    // Find smallest available block that's >= size
-    for (size_t block_size = size; block_size <= total_memory; block_size *= 2)
-    {
-        if (!free_lists[block_size].empty())
-        {
-            // Found a block, split it down to required size
-            while (block_size > size)
-            {
-                BuddyBlock *block = free_lists[block_size].back();
-                free_lists[block_size].pop_back();
-
-                size_t half_size = block_size / 2;
-
-                // Create two buddy blocks
-                BuddyBlock *left = new BuddyBlock(block->address, half_size, true);
-                BuddyBlock *right = new BuddyBlock(block->address + half_size, half_size, true);
+    return log2Floor(size) - min_block_shift;
+}
 
-                free_lists[half_size].push_back(left);
-                free_lists[half_size].push_back(right);
+bool BuddyAllocator::isFree(size_t order, size_t index)
+{
+    return free_bitmaps[order].test(index);
+}
 
-                delete block;
-                block_size = half_size;
-            }
+void BuddyAllocator::markFree(size_t order, size_t index)
+{
+    free_bitmaps[order].set(index);
+    free_counts[order]++;
+    free_block_count++;
+    nonempty_orders |= (uint64_t)1 << order;
+}
 
-            // Return the block of required size
-            if (!free_lists[size].empty())
-            {
-                BuddyBlock *result = free_lists[size].back();
-                free_lists[size].pop_back();
-                return result;
-            }
-        }
+void BuddyAllocator::markUsed(size_t order, size_t index)
+{
+    free_bitmaps[order].clear(index);
+    free_block_count--;
+    if (--free_counts[order] == 0)
+    {
+        nonempty_orders &= ~((uint64_t)1 << order);
     }
-
-    return nullptr;
 }
 
-void BuddyAllocator::mergeBuddies()
+bool BuddyAllocator::splitBlock(size_t order, size_t &address)
 {
-    bool merged = true;
-
-    while (merged)
+    // Smallest order >= the request that has a free block
+    uint64_t candidates = nonempty_orders >> order;
+    if (candidates == 0)
     {
-        merged = false;
-
-        for (size_t size = min_block_size; size < total_memory; size *= 2)
-        {
-            vector<BuddyBlock *> &blocks = free_lists[size];
-
-            for (size_t i = 0; i < blocks.size(); i++)
-            {
-                size_t buddy_addr = getBuddyAddress(blocks[i]->address, size);
-
-                // Find buddy
-                for (size_t j = 0; j < blocks.size(); j++)
-                {
-                    if (i != j && blocks[j]->address == buddy_addr)
-                    {
-                        // Found buddy, merge them
-                        size_t merged_addr = min(blocks[i]->address, blocks[j]->address);
-                        BuddyBlock *merged_block = new BuddyBlock(merged_addr, size * 2, true);
-
-                        free_lists[size * 2].push_back(merged_block);
-
-                        // Remove the two buddies
-                        BuddyBlock *first = blocks[i];
-                        BuddyBlock *second = blocks[j];
+        return false;
+    }
 
-                        blocks.erase(blocks.begin() + max(i, j));
-                        blocks.erase(blocks.begin() + min(i, j));
+    size_t block_order = order + __builtin_ctzll(candidates);
+    size_t index = free_bitmaps[block_order].findFirst();
+    markUsed(block_order, index);
 
-                        delete first;
-                        delete second;
+    // Split down to the required order, keeping the lower half each time
+    while (block_order > order)
+    {
+        block_order--;
+        index *= 2;
+        markFree(block_order, index + 1);
+    }
 
-                        merged = true;
-                        break;
-                    }
-                }
+    address = index << (min_block_shift + order);
+    return true;
+}
 
-                if (merged)
-                    break;
-            }
+void BuddyAllocator::mergeBuddies(size_t address, size_t order)
+{
+    size_t index = address >> (min_block_shift + order);
 
-            if (merged)
-                break;
-        }
+    // Climb the buddy chain while the buddy at this order is free
+    while (order < max_order && isFree(order, index ^ 1))
+    {
+        markUsed(order, index ^ 1);
+        index >>= 1;
+        order++;
     }
+
+    markFree(order, index);
 }
 
 int BuddyAllocator::malloc(size_t size)
@@ -177,18 +227,18 @@ int BuddyAllocator::malloc(size_t size)
         return -1;
     }
 
-    BuddyBlock *block = splitBlock(alloc_size);
-
-    if (block == nullptr)
+    size_t address;
+    if (!splitBlock(orderOf(alloc_size), address))
     {
         cerr << "Error: No suitable block found for size " << size << endl;
         return -1;
     }
 
-    block->is_free = false;
-    block->block_id = next_block_id++;
+    BuddyBlock *block = block_pool.create(address, alloc_size, false, next_block_id++);
     allocated_blocks[block->block_id] = block;
     requested_sizes[block->block_id] = size;
+    used_memory += block->size;
+    requested_memory += size;
 
     cout << "Allocated block id=" << block->block_id
          << " at address=0x" << hex << setfill('0')
@@ -209,16 +259,15 @@ bool BuddyAllocator::free(int block_id)
     }
 
     BuddyBlock *block = it->second;
-    block->is_free = true;
-    block->block_id = -1;
 
-    // Add to free list
-    free_lists[block->size].push_back(block);
+    used_memory -= block->size;
+    requested_memory -= requested_sizes[block_id];
     allocated_blocks.erase(it);
     requested_sizes.erase(block_id);
 
-    // Try to merge with buddies
-    mergeBuddies();
+    // Return the block and merge it with its buddies
+    mergeBuddies(block->address, orderOf(block->size));
+    block_pool.destroy(block);
 
     cout << "Block " << block_id << " freed and merged with buddies" << endl;
     return true;
@@ -241,16 +290,26 @@ void BuddyAllocator::dumpMemory()
 
     // Show free blocks by size
     cout << "\nFree Blocks by Size:" << endl;
-    for (const auto &pair : free_lists)
+    for (size_t order = 0; order <= max_order; order++)
     {
-        if (!pair.second.empty())
+        if (free_counts[order] == 0)
+            continue;
+
+        size_t size = min_block_size << order;
+        cout << "  Size " << size << ": " << free_counts[order] << " blocks" << endl;
+
+        const vector<uint64_t> &bitmap = free_bitmaps[order].words();
+        for (size_t word = 0; word < bitmap.size(); word++)
         {
-            cout << "  Size " << pair.first << ": " << pair.second.size() << " blocks" << endl;
-            for (const auto &block : pair.second)
+            uint64_t bits = bitmap[word];
+            while (bits != 0)
             {
+                size_t address = (word * 64 + __builtin_ctzll(bits)) * size;
+                bits &= bits - 1;
+
                 cout << "    [0x" << hex << setfill('0') << setw(4)
-                     << block->address << " - 0x" << setw(4)
-                     << (block->address + block->size - 1) << "]" << dec << endl;
+                     << address << " - 0x" << setw(4)
+                     << (address + size - 1) << "]" << dec << endl;
             }
         }
     }
@@ -259,38 +318,15 @@ void BuddyAllocator::dumpMemory()
 
 double BuddyAllocator::calculateInternalFragmentation()
 {
-    if (allocated_blocks.empty())
+    if (used_memory == 0)
         return 0.0;
 
-    size_t total_allocated = 0;
-    size_t total_wasted = 0;
-
-    for (const auto &pair : allocated_blocks)
-    {
-        int block_id = pair.first;
-        BuddyBlock *block = pair.second;
-        size_t requested = requested_sizes[block_id];
-        size_t allocated = block->size;
-
-        total_allocated += allocated;
-        total_wasted += (allocated - requested);
-    }
-
-    if (total_allocated == 0)
-        return 0.0;
-
-    return (double)total_wasted / total_allocated * 100.0;
+    size_t total_wasted = used_memory - requested_memory;
+    return (double)total_wasted / used_memory * 100.0;
 }
 
 void BuddyAllocator::printStats()
 {
-    size_t used_memory = 0;
-
-    for (const auto &pair : allocated_blocks)
-    {
-        used_memory += pair.second->size;
-    }
-
     cout << "\n=== Buddy Allocator Statistics ===" << endl;
     cout << "Total memory: " << total_memory << " bytes" << endl;
     cout << "Used memory: " << used_memory << " bytes" << endl;
@@ -299,12 +335,17 @@ void BuddyAllocator::printStats()
     cout << "Internal fragmentation: " << fixed << setprecision(2) << calculateInternalFragmentation() << "%" << endl;
     cout << "Minimum block size: " << min_block_size << " bytes" << endl;
     cout << "Number of allocated blocks: " << allocated_blocks.size() << endl;
+    cout << "Number of free blocks: " << free_block_count << endl;
+    cout << "Bitmap metadata: " << getMetadataBytes() << " bytes" << endl;
+    cout << endl;
+}
 
-    int total_free_blocks = 0;
-    for (const auto &pair : free_lists)
+size_t BuddyAllocator::getMetadataBytes() const
+{
+    size_t total = 0;
+    for (const auto &bitmap : free_bitmaps)
     {
-        total_free_blocks += pair.second.size();
+        total += bitmap.bytes();
     }
-    cout << "Number of free blocks: " << total_free_blocks << endl;
-    cout << endl;
+    return total;
 }
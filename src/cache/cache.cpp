@@ -3,175 +3,539 @@
 #include <iomanip>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <thread>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
-CacheLevel::CacheLevel(size_t size, size_t block_sz, size_t assoc, ReplacementPolicy pol)
-    : cache_size(size), block_size(block_sz), associativity(assoc), policy(pol),
-      current_time(0), hits(0), misses(0)
+const uint64_t CacheLevel::INVALID_TAG;
+const uint64_t CacheHierarchy::SIDE_CACHE_LATENCY;
+const size_t CacheHierarchy::MAX_SHARD_BYTES;
+const uint64_t CacheHierarchy::DEFAULT_MEMORY_LATENCY;
+
+// Default hit latencies in cycles for L1, L2 and L3 and beyond
+static const uint64_t DEFAULT_HIT_LATENCY[] = {4, 12, 40};
+
+static bool isPowerOf2(size_t n)
+{
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+static unsigned log2Floor(size_t n)
+{
+    return 63 - __builtin_clzll(n);
+}
+
+#if defined(__SSE4_1__) && !defined(__AVX2__)
+// Built for the SSE4.1 baseline: the AVX2 tag match is compiled separately
+// and used when the CPU supports it
+static bool detectAVX2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+static const bool HAS_AVX2 = detectAVX2();
+
+__attribute__((target("avx2")))
+static int findWayAVX2(const uint64_t *set, size_t associativity, uint64_t tag)
+{
+    __m256i needle = _mm256_set1_epi64x((long long)tag);
+    size_t way = 0;
+    for (; way + 4 <= associativity; way += 4)
+    {
+        __m256i lane = _mm256_loadu_si256((const __m256i *)(set + way));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lane, needle)));
+        if (mask != 0)
+        {
+            return way + __builtin_ctz(mask);
+        }
+    }
+    for (; way < associativity; way++)
+    {
+        if (set[way] == tag)
+        {
+            return way;
+        }
+    }
+    return -1;
+}
+#endif
+
+CacheLevel::CacheLevel(size_t size, size_t block_sz, size_t assoc, ReplacementPolicy pol,
+                       WritePolicy write_pol, WriteMissPolicy miss_pol)
+    : cache_size(size), block_size(block_sz), num_sets(size / (block_sz * assoc)),
+      associativity(assoc), policy(pol), write_policy(write_pol), write_miss_policy(miss_pol),
+      hit_latency(defaultHitLatency(0)),
+      replacement(pol, num_sets, assoc), current_cycle(0), hits(0), misses(0), writebacks(0),
+      prefetches_issued(0), prefetches_useful(0), prefetches_late(0),
+      compulsory_misses(0), capacity_misses(0), conflict_misses(0)
 {
 
-    num_sets = cache_size / (block_size * associativity);
+    pow2_geometry = isPowerOf2(block_size) && isPowerOf2(num_sets);
+    block_shift = pow2_geometry ? log2Floor(block_size) : 0;
+    tag_shift = pow2_geometry ? block_shift + log2Floor(num_sets) : 0;
+    set_mask = pow2_geometry ? num_sets - 1 : 0;
 
-    cache_sets.resize(num_sets);
-    for (size_t i = 0; i < num_sets; i++)
+    size_t lines = num_sets * associativity;
+    tags.assign(lines, INVALID_TAG);
+    line_data.assign(lines * block_size, 0);
+    dirty.assign(lines, 0);
+    prefetched.assign(lines, 0);
+    ready_cycle.assign(lines, 0);
+}
+
+bool CacheLevel::validGeometry(size_t size, size_t block_sz, size_t assoc)
+{
+    if (block_sz == 0 || assoc == 0 || size == 0 || size % (block_sz * assoc) != 0)
     {
-        cache_sets[i].resize(associativity);
+        cerr << "Error: Cache size must be a multiple of block size x associativity" << endl;
+        return false;
     }
+    return true;
+}
+
+uint64_t CacheLevel::defaultHitLatency(size_t depth)
+{
+    size_t defaults = sizeof(DEFAULT_HIT_LATENCY) / sizeof(DEFAULT_HIT_LATENCY[0]);
+    return DEFAULT_HIT_LATENCY[min(depth, defaults - 1)];
 }
 
-size_t CacheLevel::getSetIndex(size_t address)
+size_t CacheLevel::getSetIndex(size_t address) const
 {
+    if (pow2_geometry)
+    {
+        return (address >> block_shift) & set_mask;
+    }
     return (address / block_size) % num_sets;
 }
 
-size_t CacheLevel::getTag(size_t address)
+size_t CacheLevel::getTag(size_t address) const
 {
+    if (pow2_geometry)
+    {
+        return address >> tag_shift;
+    }
     return address / (block_size * num_sets);
 }
 
-int CacheLevel::findVictim(size_t set_index)
+size_t CacheLevel::getOffset(size_t address) const
+{
+    if (pow2_geometry)
+    {
+        return address & (block_size - 1);
+    }
+    return address % block_size;
+}
+
+size_t CacheLevel::lineAddress(size_t set_index, uint64_t tag) const
 {
-    vector<CacheLine> &set = cache_sets[set_index];
+    if (pow2_geometry)
+    {
+        return (tag << tag_shift) | (set_index << block_shift);
+    }
+    return (tag * num_sets + set_index) * block_size;
+}
+
+int CacheLevel::findWay(size_t set_index, uint64_t tag) const
+{
+    const uint64_t *set = &tags[set_index * associativity];
+    size_t way = 0;
 
-    for (size_t i = 0; i < associativity; i++)
+#if defined(__AVX2__)
+    __m256i needle = _mm256_set1_epi64x((long long)tag);
+    for (; way + 4 <= associativity; way += 4)
     {
-        if (!set[i].valid)
+        __m256i lane = _mm256_loadu_si256((const __m256i *)(set + way));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lane, needle)));
+        if (mask != 0)
         {
-            return i;
+            return way + __builtin_ctz(mask);
         }
     }
-
-    switch (policy)
+#elif defined(__SSE4_1__)
+    if (HAS_AVX2 && associativity >= 4)
     {
-    case ReplacementPolicy::FIFO:
+        return findWayAVX2(set, associativity, tag);
+    }
+    __m128i needle = _mm_set1_epi64x((long long)tag);
+    for (; way + 2 <= associativity; way += 2)
     {
-        int oldest_way = 0;
-        int oldest_time = set[0].timestamp;
-        for (size_t i = 1; i < associativity; i++)
+        __m128i lane = _mm_loadu_si128((const __m128i *)(set + way));
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(lane, needle)));
+        if (mask != 0)
         {
-            if (set[i].timestamp < oldest_time)
-            {
-                oldest_time = set[i].timestamp;
-                oldest_way = i;
-            }
+            return way + __builtin_ctz(mask);
         }
-        return oldest_way;
     }
+#endif
 
-    case ReplacementPolicy::LRU:
+    for (; way < associativity; way++)
     {
-        int lru_way = 0;
-        int oldest_time = set[0].timestamp;
-        for (size_t i = 1; i < associativity; i++)
+        if (set[way] == tag)
         {
-            if (set[i].timestamp < oldest_time)
-            {
-                oldest_time = set[i].timestamp;
-                lru_way = i;
-            }
+            return way;
         }
-        return lru_way;
     }
 
-    case ReplacementPolicy::LFU:
+    return -1;
+}
+
+int CacheLevel::findVictim(size_t set_index)
+{
+    int empty_way = findWay(set_index, INVALID_TAG);
+    if (empty_way >= 0)
+    {
+        return empty_way;
+    }
+
+    return replacement.victim(set_index);
+}
+
+bool CacheLevel::consumePrefetch(size_t line)
+{
+    if (!prefetched[line])
+    {
+        return false;
+    }
+
+    prefetched[line] = 0;
+    prefetches_useful++;
+    if (current_cycle < ready_cycle[line])
     {
-        int lfu_way = 0;
-        int min_freq = set[0].frequency;
-        for (size_t i = 1; i < associativity; i++)
+        prefetches_late++;
+    }
+    return true;
+}
+
+void CacheLevel::classify(size_t address, bool hit, bool allocate)
+{
+    size_t block = pow2_geometry ? address >> block_shift : address / block_size;
+    MissType type = classifier.reference(block, allocate);
+    if (hit)
+    {
+        return;
+    }
+
+    switch (type)
+    {
+    case MissType::COMPULSORY:
+        compulsory_misses++;
+        break;
+    case MissType::CAPACITY:
+        capacity_misses++;
+        break;
+    case MissType::CONFLICT:
+        conflict_misses++;
+        break;
+    }
+}
+
+void CacheLevel::setMissClassification(bool enabled)
+{
+    classifier = MissClassifier(enabled ? num_sets * associativity : 0);
+    compulsory_misses = 0;
+    capacity_misses = 0;
+    conflict_misses = 0;
+}
+
+bool CacheLevel::access(size_t address, size_t &data, bool *prefetch_hit, bool demand)
+{
+    size_t set_index = getSetIndex(address);
+    int way = findWay(set_index, getTag(address));
+    if (demand && classifier.isEnabled())
+    {
+        classify(address, way >= 0, true);
+    }
+
+    if (way < 0)
+    {
+        // Cache miss
+        misses++;
+        if (demand)
         {
-            if (set[i].frequency < min_freq)
-            {
-                min_freq = set[i].frequency;
-                lfu_way = i;
-            }
+            replacement.onMiss(set_index);
         }
-        return lfu_way;
+        return false;
+    }
+
+    // Cache hit
+    size_t line = set_index * associativity + way;
+    bool first_use = consumePrefetch(line);
+    if (prefetch_hit != nullptr)
+    {
+        *prefetch_hit = first_use;
+    }
+
+    hits++;
+    data = line_data[line * block_size + getOffset(address)];
+    replacement.onHit(set_index, way);
+    return true;
+}
+
+bool CacheLevel::write(size_t address, size_t data, bool *prefetch_hit)
+{
+    size_t set_index = getSetIndex(address);
+    int way = findWay(set_index, getTag(address));
+    if (classifier.isEnabled())
+    {
+        classify(address, way >= 0, write_miss_policy == WriteMissPolicy::WRITE_ALLOCATE);
+    }
+
+    if (way < 0)
+    {
+        misses++;
+        replacement.onMiss(set_index);
+        return false;
+    }
+
+    size_t line = set_index * associativity + way;
+    bool first_use = consumePrefetch(line);
+    if (prefetch_hit != nullptr)
+    {
+        *prefetch_hit = first_use;
+    }
+
+    hits++;
+    line_data[line * block_size + getOffset(address)] = data;
+    if (write_policy == WritePolicy::WRITE_BACK)
+    {
+        dirty[line] = 1;
+    }
+    replacement.onHit(set_index, way);
+    return true;
+}
+
+bool CacheLevel::contains(size_t address) const
+{
+    return findWay(getSetIndex(address), getTag(address)) >= 0;
+}
+
+void CacheLevel::markPrefetched(size_t address, uint64_t ready)
+{
+    size_t set_index = getSetIndex(address);
+    int way = findWay(set_index, getTag(address));
+
+    if (way < 0)
+    {
+        return;
+    }
+
+    size_t line = set_index * associativity + way;
+    prefetched[line] = 1;
+    ready_cycle[line] = ready;
+    prefetches_issued++;
+}
+
+bool CacheLevel::update(size_t address, const size_t *words, size_t count, bool mark_dirty)
+{
+    // Overwrite `count` words of a resident line, starting at `address`,
+    // without counting an access (used for writebacks and refills)
+    size_t set_index = getSetIndex(address);
+    int way = findWay(set_index, getTag(address));
+
+    if (way < 0)
+    {
+        return false;
+    }
+
+    size_t line = set_index * associativity + way;
+    memcpy(&line_data[line * block_size + getOffset(address)], words, count * sizeof(size_t));
+    if (mark_dirty)
+    {
+        dirty[line] = 1;
     }
+    return true;
+}
+
+bool CacheLevel::readWords(size_t address, size_t *words, size_t count) const
+{
+    // Copy `count` words of a resident line, starting at `address`
+    size_t set_index = getSetIndex(address);
+    int way = findWay(set_index, getTag(address));
+
+    if (way < 0)
+    {
+        return false;
     }
 
-    return 0;
+    size_t line = set_index * associativity + way;
+    memcpy(words, &line_data[line * block_size + getOffset(address)], count * sizeof(size_t));
+    return true;
 }
 
-void CacheLevel::updateLRU(size_t set_index, size_t way)
+void CacheLevel::saveLine(size_t line, size_t set_index, EvictedLine *out) const
 {
-    cache_sets[set_index][way].timestamp = current_time++;
-    if (policy == ReplacementPolicy::LFU)
+    out->valid = tags[line] != INVALID_TAG;
+    if (!out->valid)
     {
-        cache_sets[set_index][way].frequency++;
+        return;
     }
+
+    const size_t *block = &line_data[line * block_size];
+    out->dirty = dirty[line];
+    out->address = lineAddress(set_index, tags[line]);
+    out->data.assign(block, block + block_size);
 }
 
-bool CacheLevel::access(size_t address, size_t &data)
+void CacheLevel::insert(size_t address, const size_t *block, bool is_dirty, EvictedLine *evicted)
 {
+    // `block` holds the whole block containing `address`
     size_t set_index = getSetIndex(address);
     size_t tag = getTag(address);
 
-    vector<CacheLine> &set = cache_sets[set_index];
+    replacement.prepareInsert(set_index, tag);
+    int victim_way = findVictim(set_index);
+
+    size_t line = set_index * associativity + victim_way;
+    if (evicted != nullptr)
+    {
+        saveLine(line, set_index, evicted);
+    }
 
-    // Check for hit
-    for (size_t i = 0; i < associativity; i++)
+    if (tags[line] != INVALID_TAG)
     {
-        if (set[i].valid && set[i].tag == tag)
+        if (dirty[line])
         {
-            // Cache hit
-            hits++;
-            data = set[i].data;
-            updateLRU(set_index, i);
-            return true;
+            writebacks++;
         }
+        replacement.onEvict(set_index, victim_way, tags[line]);
     }
 
-    // Cache miss
-    misses++;
-    return false;
+    tags[line] = tag;
+    memcpy(&line_data[line * block_size], block, block_size * sizeof(size_t));
+    dirty[line] = is_dirty;
+    prefetched[line] = 0;
+    replacement.onInsert(set_index, victim_way);
 }
 
-void CacheLevel::insert(size_t address, size_t data)
+bool CacheLevel::invalidate(size_t address, EvictedLine *removed)
 {
     size_t set_index = getSetIndex(address);
-    size_t tag = getTag(address);
+    int way = findWay(set_index, getTag(address));
 
-    int victim_way = findVictim(set_index);
+    if (way < 0)
+    {
+        return false;
+    }
 
-    CacheLine &line = cache_sets[set_index][victim_way];
-    line.valid = true;
-    line.tag = tag;
-    line.data = data;
-    line.timestamp = current_time++;
-    if (policy == ReplacementPolicy::LFU)
+    size_t line = set_index * associativity + way;
+    if (removed != nullptr)
     {
-        line.frequency = 1;
+        saveLine(line, set_index, removed);
     }
+
+    replacement.onRemove(set_index, way);
+    tags[line] = INVALID_TAG;
+    dirty[line] = 0;
+    prefetched[line] = 0;
+    return true;
 }
 
 void CacheLevel::printStats(const string &level_name)
 {
-    size_t total_accesses = hits + misses;
+    uint64_t total_accesses = hits + misses;
     double hit_ratio = total_accesses > 0 ? (100.0 * hits / total_accesses) : 0.0;
 
     cout << level_name << " Cache Statistics:" << endl;
     cout << "  Hits: " << hits << endl;
     cout << "  Misses: " << misses << endl;
+    if (classifier.isEnabled())
+    {
+        cout << "    Compulsory: " << compulsory_misses << endl;
+        cout << "    Capacity: " << capacity_misses << endl;
+        cout << "    Conflict: " << conflict_misses << endl;
+    }
     cout << "  Total Accesses: " << total_accesses << endl;
     cout << "  Hit Ratio: " << fixed << setprecision(2)
          << hit_ratio << "%" << endl;
+    cout << "  Hit Latency: " << hit_latency << " cycles" << endl;
+    if (write_policy == WritePolicy::WRITE_BACK)
+    {
+        cout << "  Writebacks: " << writebacks << endl;
+    }
 }
 
 double CacheLevel::getHitRatio() const
 {
-    size_t total = hits + misses;
+    uint64_t total = hits + misses;
     return total > 0 ? (100.0 * hits / total) : 0.0;
 }
 
+CacheLevel CacheLevel::makeShard() const
+{
+    CacheLevel shard(*this);
+    shard.hits = 0;
+    shard.misses = 0;
+    shard.writebacks = 0;
+    shard.prefetches_issued = 0;
+    shard.prefetches_useful = 0;
+    shard.prefetches_late = 0;
+    shard.compulsory_misses = 0;
+    shard.capacity_misses = 0;
+    shard.conflict_misses = 0;
+    return shard;
+}
+
+void CacheLevel::mergeShard(const CacheLevel &shard, size_t set_group, size_t partitions, size_t partition)
+{
+    for (size_t set = 0; set < num_sets; set++)
+    {
+        if ((set / set_group) % partitions != partition)
+        {
+            continue;
+        }
+
+        size_t first = set * associativity;
+        copy(shard.tags.begin() + first, shard.tags.begin() + first + associativity, tags.begin() + first);
+        copy(shard.dirty.begin() + first, shard.dirty.begin() + first + associativity, dirty.begin() + first);
+        copy(shard.prefetched.begin() + first, shard.prefetched.begin() + first + associativity,
+             prefetched.begin() + first);
+        copy(shard.ready_cycle.begin() + first, shard.ready_cycle.begin() + first + associativity,
+             ready_cycle.begin() + first);
+        copy(shard.line_data.begin() + first * block_size,
+             shard.line_data.begin() + (first + associativity) * block_size,
+             line_data.begin() + first * block_size);
+        replacement.copySet(shard.replacement, set);
+    }
+
+    hits += shard.hits;
+    misses += shard.misses;
+    writebacks += shard.writebacks;
+    prefetches_issued += shard.prefetches_issued;
+    prefetches_useful += shard.prefetches_useful;
+    prefetches_late += shard.prefetches_late;
+    compulsory_misses += shard.compulsory_misses;
+    capacity_misses += shard.capacity_misses;
+    conflict_misses += shard.conflict_misses;
+}
+
 CacheHierarchy::CacheHierarchy(size_t mem_size)
-    : memory_size(mem_size)
+    : backing(nullptr), memory_size(mem_size), inclusion(InclusionPolicy::NINE), memory_reads(0), memory_writes(0),
+      memory_latency(DEFAULT_MEMORY_LATENCY), access_cycles(0), last_access_cycles(0),
+      classify_misses(false), non_blocking(false), issue_cycle(0), finish_cycle(0),
+      mshr_stall_cycles(0), blocking_stall_cycles(0), timed_accesses(0), clock_cycle(0)
 {
-    main_memory = new size_t[memory_size];
+}
 
-    for (size_t i = 0; i < memory_size; i++)
+CacheHierarchy::CacheHierarchy(const CacheHierarchy *parent)
+    : main_memory(&parent->main_memory), backing(nullptr), memory_size(parent->memory_size),
+      inclusion(parent->inclusion), memory_reads(0), memory_writes(0),
+      back_invalidations(parent->levels.size(), 0), memory_latency(parent->memory_latency),
+      access_cycles(0), last_access_cycles(0), classify_misses(parent->classify_misses),
+      non_blocking(false), mshrs(parent->levels.size()), issue_cycle(0), finish_cycle(0),
+      mshr_stall_cycles(0), blocking_stall_cycles(0), timed_accesses(0), clock_cycle(parent->clock_cycle)
+{
+    for (CacheLevel *level : parent->levels)
     {
-        main_memory[i] = 0;
+        levels.push_back(new CacheLevel(level->makeShard()));
+        SideCache none = {SideCacheType::VICTIM, nullptr};
+        side_caches.push_back(none);
+        prefetchers.push_back(nullptr);
     }
 }
 
@@ -181,71 +545,1077 @@ CacheHierarchy::~CacheHierarchy()
     {
         delete level;
     }
-    delete[] main_memory;
+    for (auto &side : side_caches)
+    {
+        delete side.buffer;
+    }
+    for (auto prefetcher : prefetchers)
+    {
+        delete prefetcher;
+    }
 }
 
-void CacheHierarchy::addLevel(size_t size, size_t block_size,
-                              size_t associativity, ReplacementPolicy policy)
+bool CacheHierarchy::uniformBlockSize(size_t block_size) const
 {
-    levels.push_back(new CacheLevel(size, block_size, associativity, policy));
+    for (auto level : levels)
+    {
+        if (level->getBlockSize() != block_size)
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
-size_t CacheHierarchy::read(size_t address)
+bool CacheHierarchy::addLevel(size_t size, size_t block_size,
+                              size_t associativity, ReplacementPolicy policy,
+                              WritePolicy write_policy, WriteMissPolicy miss_policy)
 {
-    if (address >= memory_size)
+    // Blocks move whole between exclusive levels, so they must agree on size
+    if (inclusion == InclusionPolicy::EXCLUSIVE && !uniformBlockSize(block_size))
     {
-        cerr << "Error: Address " << address << " out of bounds" << endl;
-        return 0;
+        cerr << "Error: Exclusive hierarchy requires the same block size at every level" << endl;
+        return false;
     }
 
-    size_t data;
+    if (!CacheLevel::validGeometry(size, block_size, associativity))
+    {
+        return false;
+    }
 
-    for (size_t i = 0; i < levels.size(); i++)
+    // A fill hands each level whole blocks cut from the block below it
+    if (!levels.empty())
     {
-        if (levels[i]->access(address, data))
+        size_t upper = levels.back()->getBlockSize();
+        if (block_size < upper || block_size % upper != 0)
         {
-            return data;
+            cerr << "Error: Block size must be a multiple of the previous level's block size ("
+                 << upper << ")" << endl;
+            return false;
         }
     }
 
-    data = main_memory[address];
+    levels.push_back(new CacheLevel(size, block_size, associativity, policy,
+                                    write_policy, miss_policy));
+    levels.back()->setMissClassification(classify_misses);
+    levels.back()->setHitLatency(CacheLevel::defaultHitLatency(levels.size() - 1));
+    back_invalidations.push_back(0);
+    SideCache none = {SideCacheType::VICTIM, nullptr};
+    side_caches.push_back(none);
+    prefetchers.push_back(nullptr);
+    mshrs.push_back(MSHRFile());
+    return true;
+}
 
-    for (auto level : levels)
+bool CacheHierarchy::setInclusionPolicy(InclusionPolicy policy)
+{
+    if (policy == InclusionPolicy::EXCLUSIVE && !levels.empty() &&
+        !uniformBlockSize(levels[0]->getBlockSize()))
     {
-        level->insert(address, data);
+        cerr << "Error: Exclusive hierarchy requires the same block size at every level" << endl;
+        return false;
     }
 
-    return data;
+    // Miss cache copies would duplicate blocks that exclusion moves around
+    if (policy == InclusionPolicy::EXCLUSIVE)
+    {
+        for (auto &side : side_caches)
+        {
+            if (side.buffer != nullptr && side.type == SideCacheType::MISS)
+            {
+                cerr << "Error: Miss caches cannot be used in an exclusive hierarchy" << endl;
+                return false;
+            }
+        }
+    }
+
+    inclusion = policy;
+    return true;
 }
 
-void CacheHierarchy::write(size_t address, size_t data)
+bool CacheHierarchy::setHitLatency(size_t level, uint64_t cycles)
 {
-    if (address >= memory_size)
+    if (level >= levels.size())
     {
-        cerr << "Error: Address " << address << " out of bounds" << endl;
-        return;
+        cerr << "Error: Cache level L" << level + 1 << " does not exist" << endl;
+        return false;
     }
 
-    main_memory[address] = data;
+    levels[level]->setHitLatency(cycles);
+    return true;
+}
 
-    for (auto level : levels)
+bool CacheHierarchy::setMSHRs(size_t level, size_t entries)
+{
+    if (level >= levels.size())
+    {
+        cerr << "Error: Cache level L" << level + 1 << " does not exist" << endl;
+        return false;
+    }
+
+    mshrs[level] = MSHRFile(entries);
+
+    // The timing model starts over with the new configuration
+    non_blocking = false;
+    for (size_t i = 0; i < mshrs.size(); i++)
+    {
+        mshrs[i] = MSHRFile(mshrs[i].getEntries());
+        non_blocking = non_blocking || mshrs[i].getEntries() > 0;
+    }
+    issue_cycle = 0;
+    finish_cycle = 0;
+    mshr_stall_cycles = 0;
+    blocking_stall_cycles = 0;
+    timed_accesses = 0;
+    return true;
+}
+
+void CacheHierarchy::setMissClassification(bool enabled)
+{
+    // Levels added later follow the same setting
+    classify_misses = enabled;
+    for (CacheLevel *level : levels)
+    {
+        level->setMissClassification(enabled);
+    }
+}
+
+bool CacheHierarchy::setSideCache(size_t level, SideCacheType type, size_t entries)
+{
+    if (level >= levels.size())
+    {
+        cerr << "Error: Cache level L" << level + 1 << " does not exist" << endl;
+        return false;
+    }
+
+    if (type == SideCacheType::MISS && inclusion == InclusionPolicy::EXCLUSIVE)
+    {
+        cerr << "Error: Miss caches cannot be used in an exclusive hierarchy" << endl;
+        return false;
+    }
+
+    // One set holding every entry: fully associative, LRU
+    size_t block_size = levels[level]->getBlockSize();
+    delete side_caches[level].buffer;
+    side_caches[level].type = type;
+    side_caches[level].buffer = new CacheLevel(entries * block_size, block_size, entries,
+                                               ReplacementPolicy::LRU);
+    return true;
+}
+
+bool CacheHierarchy::probeSideCache(size_t level, size_t address, bool &was_dirty)
+{
+    SideCache &side = side_caches[level];
+    if (side.buffer == nullptr)
+    {
+        return false;
+    }
+
+    access_cycles += SIDE_CACHE_LATENCY;
+    size_t word;
+    if (!side.buffer->access(address, word))
     {
-        size_t dummy;
-        if (level->access(address, dummy))
+        return false;
+    }
+
+    size_t block_size = side.buffer->getBlockSize();
+    side_block.resize(block_size);
+    side.buffer->readWords(address - address % block_size, side_block.data(), block_size);
+
+    was_dirty = false;
+    if (side.type == SideCacheType::VICTIM)
+    {
+        // The line goes back into the level, so it leaves the victim cache
+        EvictedLine parked;
+        side.buffer->invalidate(address, &parked);
+        was_dirty = parked.dirty;
+    }
+    return true;
+}
+
+void CacheHierarchy::refreshSideCache(size_t level, size_t address, const size_t *words, size_t count)
+{
+    // Keep a miss cache's copy in step with the level
+    if (side_caches[level].buffer != nullptr)
+    {
+        side_caches[level].buffer->update(address, words, count, false);
+    }
+}
+
+bool CacheHierarchy::updateLine(size_t level, size_t address, const size_t *words,
+                                size_t count, bool mark_dirty)
+{
+    // The block is resident if the level or its victim cache holds it; a
+    // miss cache only holds copies, which are refreshed but do not count
+    bool resident = levels[level]->update(address, words, count, mark_dirty);
+
+    SideCache &side = side_caches[level];
+    if (side.buffer != nullptr)
+    {
+        bool victim = side.type == SideCacheType::VICTIM;
+        if (side.buffer->update(address, words, count, victim && mark_dirty) && victim)
         {
-            level->insert(address, data);
+            resident = true;
         }
     }
+    return resident;
 }
 
-void CacheHierarchy::printAllStats()
+bool CacheHierarchy::setPrefetcher(size_t level, PrefetcherType type,
+                                   size_t degree, size_t distance, size_t latency)
 {
-    cout << "\n=== Cache Hierarchy Statistics ===" << endl;
+    if (level >= levels.size())
+    {
+        cerr << "Error: Cache level L" << level + 1 << " does not exist" << endl;
+        return false;
+    }
 
-    for (size_t i = 0; i < levels.size(); i++)
+    delete prefetchers[level];
+    prefetchers[level] = new Prefetcher(type, degree, distance, latency);
+    return true;
+}
+
+void CacheHierarchy::observe(size_t level, size_t address, bool hit, bool prefetch_hit)
+{
+    Prefetcher *prefetcher = prefetchers[level];
+    if (prefetcher == nullptr)
     {
-        string level_name = "L" + to_string(i + 1);
-        levels[i]->printStats(level_name);
-        cout << endl;
+        return;
+    }
+
+    size_t block_size = levels[level]->getBlockSize();
+    prefetch_candidates.clear();
+    prefetcher->observe(address / block_size, !hit || prefetch_hit, prefetch_candidates);
+
+    for (size_t block : prefetch_candidates)
+    {
+        pending_prefetches.push_back(make_pair(level, block * block_size));
+    }
+}
+
+void CacheHierarchy::noteLookup(size_t level, bool hit, bool fills)
+{
+    if (non_blocking)
+    {
+        DemandLookup lookup = {level, hit, fills, false, false};
+        demand_lookups.push_back(lookup);
+    }
+}
+
+uint64_t CacheHierarchy::scheduleAccess(size_t address)
+{
+    uint64_t start = issue_cycle;
+    uint64_t merged_ready = 0;
+    bool blocking_miss = false;
+
+    // Find the misses still in flight when the access starts and the MSHRs
+    // the others need. Waiting for a free MSHR moves the start, which can
+    // retire fills the access would otherwise merge into, so repeat until
+    // the start is settled.
+    for (;;)
+    {
+        uint64_t needed = start;
+        merged_ready = 0;
+        blocking_miss = false;
+
+        for (DemandLookup &lookup : demand_lookups)
+        {
+            MSHRFile &file = mshrs[lookup.level];
+            size_t block = address / levels[lookup.level]->getBlockSize();
+            uint64_t fill_ready;
+
+            lookup.merged = file.findPending(block, start, fill_ready);
+            lookup.allocate = false;
+            if (lookup.merged)
+            {
+                merged_ready = max(merged_ready, fill_ready);
+            }
+            else if (!lookup.hit && lookup.fills)
+            {
+                if (file.getEntries() == 0)
+                {
+                    blocking_miss = true;
+                    continue;
+                }
+                needed = max(needed, file.nextFree(start));
+                lookup.allocate = true;
+            }
+        }
+
+        if (needed == start)
+        {
+            break;
+        }
+        start = needed;
+    }
+
+    uint64_t finish = max(start + access_cycles, merged_ready);
+    for (const DemandLookup &lookup : demand_lookups)
+    {
+        MSHRFile &file = mshrs[lookup.level];
+        if (lookup.merged)
+        {
+            file.recordMerge();
+        }
+        else if (lookup.allocate)
+        {
+            if (file.nextFree(issue_cycle) > issue_cycle)
+            {
+                file.recordFullStall();
+            }
+            file.allocate(address / levels[lookup.level]->getBlockSize(), start, finish);
+        }
+    }
+
+    // The next access issues a cycle later, or once a blocking fill is done
+    mshr_stall_cycles += start - issue_cycle;
+    issue_cycle = start + 1;
+    if (blocking_miss && finish > issue_cycle)
+    {
+        blocking_stall_cycles += finish - issue_cycle;
+        issue_cycle = finish;
+    }
+    finish_cycle = max(finish_cycle, finish);
+    timed_accesses++;
+    demand_lookups.clear();
+    return finish;
+}
+
+void CacheHierarchy::startAccess()
+{
+    access_cycles = 0;
+    for (CacheLevel *level : levels)
+    {
+        level->setCycle(clock_cycle);
+    }
+}
+
+void CacheHierarchy::finishAccess(size_t address)
+{
+    last_access_cycles = access_cycles;
+    latency.record(access_cycles);
+
+    // The prefetches this access triggered issue once it completes
+    uint64_t done = clock_cycle + access_cycles;
+    if (non_blocking)
+    {
+        uint64_t issued = issue_cycle;
+        done = clock_cycle + (scheduleAccess(address) - issued);
+        clock_cycle += issue_cycle - issued;
+    }
+    else
+    {
+        clock_cycle = done;
+    }
+
+    // Prefetches complete in the background; their cycles are not charged
+    issuePrefetches(done);
+}
+
+void CacheHierarchy::issuePrefetches(uint64_t issue)
+{
+    for (size_t i = 0; i < pending_prefetches.size(); i++)
+    {
+        size_t level = pending_prefetches[i].first;
+        size_t address = pending_prefetches[i].second;
+
+        CacheLevel *side = side_caches[level].buffer;
+        if (address >= memory_size || levels[level]->contains(address) ||
+            (side != nullptr && side->contains(address)))
+        {
+            continue;
+        }
+
+        // Prefetch requests go down like misses but do not train the
+        // prefetchers of the levels they pass through. The line is ready
+        // once the prefetcher's own latency and the fetch have elapsed.
+        bool was_dirty;
+        uint64_t before = access_cycles;
+        const size_t *block = fetchBelow(level, address, was_dirty, false);
+        fill(level, address, block, was_dirty);
+        uint64_t ready = issue + prefetchers[level]->getLatency() + (access_cycles - before);
+        levels[level]->markPrefetched(address, ready);
+    }
+
+    pending_prefetches.clear();
+}
+
+const size_t *CacheHierarchy::fetchBelow(size_t level, size_t address, bool &was_dirty, bool demand,
+                                         size_t *deepest)
+{
+    size_t hit_level = levels.size();
+    bool from_side = false;
+    bool side_dirty = false;
+    was_dirty = false;
+
+    for (size_t i = level + 1; i < levels.size(); i++)
+    {
+        size_t word;
+        bool prefetch_hit = false;
+        bool hit = levels[i]->access(address, word, &prefetch_hit, demand);
+        access_cycles += levels[i]->getHitLatency();
+
+        if (demand)
+        {
+            observe(i, address, hit, prefetch_hit);
+            noteLookup(i, hit, true);
+        }
+
+        if (hit)
+        {
+            hit_level = i;
+            break;
+        }
+
+        if (probeSideCache(i, address, side_dirty))
+        {
+            hit_level = i;
+            from_side = true;
+            break;
+        }
+    }
+
+    if (deepest != nullptr)
+    {
+        *deepest = min(hit_level, levels.size() - 1);
+    }
+
+    // Block sizes never shrink going down, so the deepest level filled on
+    // the way back up has the largest block: fetch that much
+    size_t span = levels[hit_level - 1]->getBlockSize();
+    size_t base = address - address % span;
+    fetch_block.resize(span);
+
+    if (hit_level == levels.size())
+    {
+        if (backing != nullptr)
+        {
+            backing->readBlock(base, fetch_block.data(), span);
+            access_cycles += backing->getLastAccessCycles();
+        }
+        else
+        {
+            main_memory.readBlock(base, fetch_block.data(), span);
+            access_cycles += memory_latency;
+        }
+        memory_reads++;
+    }
+    else if (from_side)
+    {
+        size_t side_base = address - address % levels[hit_level]->getBlockSize();
+        memcpy(fetch_block.data(), &side_block[base - side_base], span * sizeof(size_t));
+
+        // An exclusive hierarchy moves the block straight up; otherwise
+        // it returns to its level on the way
+        if (inclusion == InclusionPolicy::EXCLUSIVE)
+        {
+            was_dirty = side_dirty;
+        }
+        else
+        {
+            fill(hit_level, address, side_block.data(), side_dirty);
+        }
+    }
+    else
+    {
+        levels[hit_level]->readWords(base, fetch_block.data(), span);
+
+        if (inclusion == InclusionPolicy::EXCLUSIVE)
+        {
+            // The block moves up, taking its dirty state with it
+            EvictedLine removed;
+            levels[hit_level]->invalidate(address, &removed);
+            was_dirty = removed.dirty;
+        }
+    }
+
+    // Fill the deepest level first, so that lines written back by the
+    // fills above land in a copy that is already up to date
+    if (inclusion != InclusionPolicy::EXCLUSIVE)
+    {
+        for (size_t i = hit_level - 1; i > level; i--)
+        {
+            size_t block_size = levels[i]->getBlockSize();
+            fill(i, address, &fetch_block[address - address % block_size - base], false);
+        }
+    }
+
+    size_t block_size = levels[level]->getBlockSize();
+    return &fetch_block[address - address % block_size - base];
+}
+
+void CacheHierarchy::fill(size_t level, size_t address, const size_t *block, bool is_dirty)
+{
+    CacheLevel *cache = levels[level];
+    size_t block_size = cache->getBlockSize();
+    size_t base = address - address % block_size;
+
+    // The block may be parked in the victim cache, whose copy is newer
+    // than anything clean arriving from below
+    SideCache &side = side_caches[level];
+    EvictedLine parked;
+    if (side.buffer != nullptr && side.type == SideCacheType::VICTIM &&
+        side.buffer->invalidate(base, &parked) && !is_dirty)
+    {
+        block = parked.data.data();
+        is_dirty = parked.dirty;
+    }
+
+    // A write-through level never holds dirty data (only an exclusive
+    // hierarchy moves a dirty block into one, and it has no other copy)
+    if (is_dirty && !cache->isWriteBack())
+    {
+        writeMemory(base, block, block_size);
+        is_dirty = false;
+    }
+
+    // A writeback may already have brought the block in
+    if (cache->update(base, block, block_size, is_dirty))
+    {
+        refreshSideCache(level, base, block, block_size);
+        return;
+    }
+
+    EvictedLine evicted;
+    cache->insert(address, block, is_dirty, &evicted);
+
+    if (side.buffer != nullptr)
+    {
+        if (side.type == SideCacheType::MISS)
+        {
+            if (!side.buffer->update(base, block, block_size, false))
+            {
+                side.buffer->insert(address, block);
+            }
+        }
+        else if (evicted.valid)
+        {
+            // Park the victim; whatever the victim cache displaces leaves
+            // the level for good
+            EvictedLine displaced;
+            side.buffer->insert(evicted.address, evicted.data.data(), evicted.dirty, &displaced);
+            swap(evicted, displaced);
+        }
+    }
+
+    if (evicted.valid)
+    {
+        evict(level, evicted);
+    }
+}
+
+void CacheHierarchy::evict(size_t level, EvictedLine &line)
+{
+    switch (inclusion)
+    {
+    case InclusionPolicy::EXCLUSIVE:
+        // Victim fill: the evicted line moves down one level
+        if (level + 1 < levels.size())
+        {
+            fill(level + 1, line.address, line.data.data(), line.dirty);
+        }
+        else if (line.dirty)
+        {
+            writeMemory(line.address, line.data.data(), line.data.size());
+        }
+        break;
+
+    case InclusionPolicy::INCLUSIVE:
+        backInvalidate(level, line);
+        if (line.dirty)
+        {
+            // A miss-cache copy must not outlive the data merged from above
+            refreshSideCache(level, line.address, line.data.data(), line.data.size());
+            writeBack(level + 1, line.address, line.data.data(), line.data.size());
+        }
+        break;
+
+    case InclusionPolicy::NINE:
+        if (line.dirty)
+        {
+            writeBack(level + 1, line.address, line.data.data(), line.data.size());
+        }
+        break;
+    }
+}
+
+void CacheHierarchy::backInvalidate(size_t level, EvictedLine &line)
+{
+    // Remove every copy of the evicted block from the levels above. Dirty
+    // copies are newer than the departing line, so their words are merged
+    // into it; the nearest level goes last as it holds the newest data.
+    size_t block_end = line.address + line.data.size();
+
+    for (size_t upper = level; upper-- > 0;)
+    {
+        size_t step = levels[upper]->getBlockSize();
+        CacheLevel *holders[] = {levels[upper], side_caches[upper].buffer};
+
+        for (size_t a = line.address; a < block_end; a += step)
+        {
+            for (CacheLevel *holder : holders)
+            {
+                EvictedLine removed;
+                if (holder == nullptr || !holder->invalidate(a, &removed))
+                {
+                    continue;
+                }
+
+                back_invalidations[upper]++;
+
+                if (removed.dirty)
+                {
+                    memcpy(&line.data[a - line.address], removed.data.data(), step * sizeof(size_t));
+                    line.dirty = true;
+                }
+            }
+        }
+    }
+}
+
+void CacheHierarchy::writeBack(size_t first_level, size_t address, const size_t *words, size_t count)
+{
+    // The dirty block lands in the first write-back level from first_level
+    // down; write-through levels on the way only refresh their copy. A
+    // write-back level with larger blocks cannot allocate a partial block,
+    // so if it does not hold the block already the data keeps going down.
+    for (size_t i = first_level; i < levels.size(); i++)
+    {
+        CacheLevel *cache = levels[i];
+
+        if (!cache->isWriteBack())
+        {
+            updateLine(i, address, words, count, false);
+            continue;
+        }
+
+        if (updateLine(i, address, words, count, true))
+        {
+            return;
+        }
+
+        if (cache->getBlockSize() == count)
+        {
+            fill(i, address, words, true);
+            return;
+        }
+    }
+
+    writeMemory(address, words, count);
+}
+
+void CacheHierarchy::writeMemory(size_t address, const size_t *words, size_t count)
+{
+    if (backing != nullptr)
+    {
+        backing->writeBlock(address, words, count);
+    }
+    else
+    {
+        main_memory.writeBlock(address, words, count);
+    }
+    memory_writes++;
+}
+
+void CacheHierarchy::readBlock(size_t address, size_t *words, size_t count)
+{
+    // Every read leaves the block in the first level
+    read(address);
+    if (levels.empty())
+    {
+        main_memory.readBlock(address, words, count);
+    }
+    else
+    {
+        levels[0]->readWords(address, words, count);
+    }
+}
+
+void CacheHierarchy::writeBlock(size_t address, const size_t *words, size_t count)
+{
+    writeBack(0, address, words, count);
+}
+
+size_t CacheHierarchy::read(size_t address)
+{
+    if (address >= memory_size)
+    {
+        cerr << "Error: Address " << address << " out of bounds" << endl;
+        return 0;
+    }
+
+    startAccess();
+
+    if (levels.empty())
+    {
+        memory_reads++;
+        access_cycles += memory_latency;
+        finishAccess(address);
+        return main_memory.read(address);
+    }
+
+    size_t data;
+    bool prefetch_hit = false;
+    bool hit = levels[0]->access(address, data, &prefetch_hit);
+    access_cycles += levels[0]->getHitLatency();
+    observe(0, address, hit, prefetch_hit);
+    noteLookup(0, hit, true);
+
+    if (!hit)
+    {
+        bool was_dirty;
+        const size_t *block;
+        if (probeSideCache(0, address, was_dirty))
+        {
+            block = side_block.data();
+        }
+        else
+        {
+            block = fetchBelow(0, address, was_dirty);
+        }
+        fill(0, address, block, was_dirty);
+        data = block[address % levels[0]->getBlockSize()];
+    }
+
+    finishAccess(address);
+    return data;
+}
+
+void CacheHierarchy::write(size_t address, size_t data)
+{
+    if (address >= memory_size)
+    {
+        cerr << "Error: Address " << address << " out of bounds" << endl;
+        return;
+    }
+
+    startAccess();
+
+    bool absorbed = false;
+
+    // A write-allocate fetch at a write-through level already looks up
+    // (and counts) the levels below it, down to this one
+    size_t fetched_to = 0;
+
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        CacheLevel *cache = levels[i];
+        bool fetched = i > 0 && i <= fetched_to;
+        bool present;
+        bool was_dirty;
+
+        if (fetched)
+        {
+            // Counted and charged by the fetch: only apply the write to
+            // the copy it left here
+            present = cache->update(address, &data, 1, cache->isWriteBack());
+        }
+        else
+        {
+            bool prefetch_hit = false;
+            present = cache->write(address, data, &prefetch_hit);
+            access_cycles += cache->getHitLatency();
+            observe(i, address, present, prefetch_hit);
+            noteLookup(i, present, cache->isWriteAllocate());
+        }
+
+        if (!present && !fetched && probeSideCache(i, address, was_dirty))
+        {
+            // Recovered from the side cache: refill the level, then write
+            fill(i, address, side_block.data(), was_dirty);
+            cache->update(address, &data, 1, cache->isWriteBack());
+            present = true;
+        }
+        else if (!present && !fetched && cache->isWriteAllocate())
+        {
+            // Bring the block in from below, then apply the write to it
+            const size_t *block = fetchBelow(i, address, was_dirty, true, &fetched_to);
+            fill(i, address, block, was_dirty || cache->isWriteBack());
+            cache->update(address, &data, 1, false);
+            present = true;
+        }
+
+        if (present)
+        {
+            refreshSideCache(i, address, &data, 1);
+        }
+
+        // A write-back level absorbs the write
+        if (present && cache->isWriteBack())
+        {
+            absorbed = true;
+            break;
+        }
+
+        // An exclusive hierarchy keeps the block in this level only
+        if (present && inclusion == InclusionPolicy::EXCLUSIVE)
+        {
+            break;
+        }
+    }
+
+    if (!absorbed)
+    {
+        if (backing != nullptr)
+        {
+            backing->write(address, data);
+            access_cycles += backing->getLastAccessCycles();
+        }
+        else
+        {
+            main_memory.write(address, data);
+            access_cycles += memory_latency;
+        }
+        memory_writes++;
+    }
+
+    finishAccess(address);
+}
+
+size_t CacheHierarchy::countPartitions(size_t limit) const
+{
+    // A partition is a residue of the block number at the largest (last
+    // level's) block size. That residue must pick whole groups of sets in
+    // every level, so no set is shared between partitions: with g blocks of
+    // a level per largest block, its set count must divide by g * p.
+    size_t span = levels.back()->getBlockSize();
+
+    for (size_t p = limit; p > 1; p--)
+    {
+        bool fits = true;
+        for (CacheLevel *level : levels)
+        {
+            size_t group = span / level->getBlockSize();
+            fits = fits && level->getNumSets() % (group * p) == 0;
+        }
+        if (fits)
+        {
+            return p;
+        }
+    }
+    return 1;
+}
+
+size_t CacheHierarchy::replay(const vector<TraceAccess> &trace, size_t threads)
+{
+    size_t partitions = 1;
+    if (threads > 1 && !levels.empty())
+    {
+        // Side caches and the miss classifier's shadow cache are fully
+        // associative, prefetchers follow address streams, set dueling
+        // updates one counter from many sets and MSHR timing depends on
+        // the order of all accesses, so any of them would couple the
+        // partitions
+        if (classify_misses)
+        {
+            cerr << "Error: Parallel replay does not support miss classification (the shadow cache spans all sets)" << endl;
+            return 0;
+        }
+        if (non_blocking)
+        {
+            cerr << "Error: Parallel replay does not support MSHRs (the timing model orders all accesses)" << endl;
+            return 0;
+        }
+        if (backing != nullptr)
+        {
+            cerr << "Error: Parallel replay does not support a backing hierarchy (its levels span all sets)" << endl;
+            return 0;
+        }
+
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            if (side_caches[i].buffer != nullptr || prefetchers[i] != nullptr)
+            {
+                cerr << "Error: Parallel replay does not support victim/miss caches or prefetchers" << endl;
+                return 0;
+            }
+            if (!levels[i]->isSetLocal())
+            {
+                cerr << "Error: Parallel replay does not support DRRIP (set dueling shares state between sets)" << endl;
+                return 0;
+            }
+        }
+
+        for (const TraceAccess &access : trace)
+        {
+            if (access.address >= memory_size)
+            {
+                cerr << "Error: Address " << access.address << " out of bounds" << endl;
+                return 0;
+            }
+        }
+
+        size_t footprint = 0;
+        for (CacheLevel *level : levels)
+        {
+            footprint += level->getFootprint();
+        }
+        size_t cores = max((size_t)1, (size_t)thread::hardware_concurrency());
+        size_t fit = max((size_t)1, MAX_SHARD_BYTES / max(footprint, (size_t)1));
+        partitions = countPartitions(min(threads, min(cores, fit)));
+    }
+
+    if (partitions == 1)
+    {
+        for (const TraceAccess &access : trace)
+        {
+            if (access.is_write)
+            {
+                write(access.address, access.data);
+            }
+            else
+            {
+                read(access.address);
+            }
+        }
+        return 1;
+    }
+
+    vector<CacheHierarchy *> shards;
+    for (size_t p = 0; p < partitions; p++)
+    {
+        shards.push_back(new CacheHierarchy(this));
+    }
+
+    // Every thread scans the trace and simulates the accesses of its sets
+    size_t span = levels.back()->getBlockSize();
+    auto worker = [&](size_t partition)
+    {
+        CacheHierarchy *shard = shards[partition];
+        for (const TraceAccess &access : trace)
+        {
+            if ((access.address / span) % partitions != partition)
+            {
+                continue;
+            }
+            if (access.is_write)
+            {
+                shard->write(access.address, access.data);
+            }
+            else
+            {
+                shard->read(access.address);
+            }
+        }
+    };
+
+    vector<thread> pool;
+    for (size_t p = 1; p < partitions; p++)
+    {
+        pool.push_back(thread(worker, p));
+    }
+    worker(0);
+    for (thread &t : pool)
+    {
+        t.join();
+    }
+
+    mergeShards(shards, partitions);
+    if (!trace.empty())
+    {
+        last_access_cycles = shards[(trace.back().address / span) % partitions]->last_access_cycles;
+    }
+
+    for (CacheHierarchy *shard : shards)
+    {
+        delete shard;
+    }
+    return partitions;
+}
+
+void CacheHierarchy::mergeShards(const vector<CacheHierarchy *> &shards, size_t partitions)
+{
+    size_t span = levels.back()->getBlockSize();
+    vector<const SparseMemory *> memories;
+
+    for (size_t p = 0; p < shards.size(); p++)
+    {
+        const CacheHierarchy *shard = shards[p];
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            levels[i]->mergeShard(*shard->levels[i], span / levels[i]->getBlockSize(), partitions, p);
+            back_invalidations[i] += shard->back_invalidations[i];
+        }
+
+        memory_reads += shard->memory_reads;
+        memory_writes += shard->memory_writes;
+        latency.merge(shard->latency);
+        memories.push_back(&shard->main_memory);
+    }
+
+    main_memory.mergeShards(memories);
+}
+
+void CacheHierarchy::printAllStats()
+{
+    cout << "\n=== Cache Hierarchy Statistics ===" << endl;
+
+    const char *inclusion_names[] = {"NINE", "Inclusive", "Exclusive"};
+    cout << "Inclusion policy: " << inclusion_names[(int)inclusion] << endl;
+
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        string level_name = "L" + to_string(i + 1);
+        levels[i]->printStats(level_name);
+        if (inclusion == InclusionPolicy::INCLUSIVE && i + 1 < levels.size())
+        {
+            cout << "  Back-invalidations: " << back_invalidations[i] << endl;
+        }
+        if (prefetchers[i] != nullptr)
+        {
+            Prefetcher *prefetcher = prefetchers[i];
+            cout << "  Prefetcher: " << prefetcher->getName()
+                 << " (degree " << prefetcher->getDegree()
+                 << ", distance " << prefetcher->getDistance()
+                 << ", latency " << prefetcher->getLatency() << ")" << endl;
+            cout << "  Prefetches Issued: " << levels[i]->getPrefetchesIssued() << endl;
+            cout << "  Prefetches Useful: " << levels[i]->getPrefetchesUseful() << endl;
+            cout << "  Prefetches Late: " << levels[i]->getPrefetchesLate() << endl;
+        }
+        if (side_caches[i].buffer != nullptr)
+        {
+            CacheLevel *buffer = side_caches[i].buffer;
+            const char *name = side_caches[i].type == SideCacheType::VICTIM ? "Victim Cache" : "Miss Cache";
+            uint64_t level_misses = levels[i]->getMisses();
+            double recovered = level_misses > 0 ? (100.0 * buffer->getHits() / level_misses) : 0.0;
+
+            cout << "  " << name << ": " << buffer->getAssociativity() << " entries" << endl;
+            cout << "  " << name << " Hits: " << buffer->getHits() << endl;
+            cout << "  Misses Recovered: " << fixed << setprecision(2) << recovered << "%" << endl;
+        }
+        if (mshrs[i].getEntries() > 0)
+        {
+            const MSHRFile &file = mshrs[i];
+            double occupancy = finish_cycle > 0 ? (double)file.getOccupiedCycles() / finish_cycle : 0.0;
+
+            cout << "  MSHRs: " << file.getEntries() << endl;
+            cout << "  MSHR Misses: " << file.getPrimaryMisses() << " primary, "
+                 << file.getMergedMisses() << " merged" << endl;
+            cout << "  MSHR Occupancy: " << fixed << setprecision(2) << occupancy
+                 << " average, " << file.getPeakOccupancy() << " peak" << endl;
+            cout << "  Memory-Level Parallelism: " << fixed << setprecision(2)
+                 << file.getParallelism() << endl;
+            cout << "  MSHR Full Stalls: " << file.getFullStalls() << endl;
+        }
+        cout << endl;
+    }
+
+    cout << "Main Memory Traffic:" << endl;
+    cout << "  Reads: " << memory_reads << endl;
+    cout << "  Writes: " << memory_writes << endl;
+    cout << "  Latency: " << memory_latency << " cycles" << endl;
+    cout << "  Pages touched: " << main_memory.getPagesTouched() << " ("
+         << main_memory.getBytesAllocated() / 1024 << " KB allocated)" << endl;
+    cout << "Average Memory Access Time: " << fixed << setprecision(2)
+         << latency.getAverage() << " cycles (" << latency.getAccesses() << " accesses)" << endl;
+
+    if (non_blocking)
+    {
+        double per_access = timed_accesses > 0 ? (double)finish_cycle / timed_accesses : 0.0;
+        cout << "Non-blocking Timing:" << endl;
+        cout << "  Elapsed Cycles: " << finish_cycle << " (" << fixed << setprecision(2)
+             << per_access << " per access, " << timed_accesses << " accesses)" << endl;
+        cout << "  Stall Cycles: " << mshr_stall_cycles + blocking_stall_cycles << " ("
+             << mshr_stall_cycles << " MSHRs full, " << blocking_stall_cycles << " blocking fills)" << endl;
     }
 }
@@ -0,0 +1,161 @@
+#include "../../include/cache_sweep.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+CacheSweep::CacheSweep(size_t mem_size) : memory_size(mem_size)
+{
+}
+
+CacheSweep::~CacheSweep()
+{
+    clearResults();
+}
+
+void CacheSweep::clearResults()
+{
+    for (CacheHierarchy *hierarchy : hierarchies)
+    {
+        delete hierarchy;
+    }
+    hierarchies.clear();
+}
+
+CacheHierarchy *CacheSweep::build(const vector<LevelConfig> &levels) const
+{
+    CacheHierarchy *hierarchy = new CacheHierarchy(memory_size);
+    for (const LevelConfig &level : levels)
+    {
+        if (!hierarchy->addLevel(level.size, level.block_size, level.associativity, level.policy,
+                                 level.write_policy, level.miss_policy))
+        {
+            delete hierarchy;
+            return nullptr;
+        }
+    }
+    return hierarchy;
+}
+
+bool CacheSweep::addConfig(const vector<LevelConfig> &levels)
+{
+    if (levels.empty())
+    {
+        cerr << "Error: A sweep configuration needs at least one cache level" << endl;
+        return false;
+    }
+
+    // Build it once here so invalid configurations are reported up front,
+    // not from inside a worker
+    CacheHierarchy *hierarchy = build(levels);
+    if (hierarchy == nullptr)
+    {
+        return false;
+    }
+    delete hierarchy;
+
+    configs.push_back(levels);
+    return true;
+}
+
+size_t CacheSweep::run(const vector<TraceAccess> &trace, size_t threads)
+{
+    for (const TraceAccess &access : trace)
+    {
+        if (access.address >= memory_size)
+        {
+            cerr << "Error: Trace address " << access.address << " out of bounds" << endl;
+            return 0;
+        }
+    }
+
+    // Fresh hierarchies, built on this thread so workers only simulate
+    clearResults();
+    for (const vector<LevelConfig> &levels : configs)
+    {
+        hierarchies.push_back(build(levels));
+    }
+
+    if (threads == 0)
+    {
+        threads = thread::hardware_concurrency();
+    }
+    threads = max((size_t)1, min(threads, configs.size()));
+
+    atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for (size_t c = next++; c < hierarchies.size(); c = next++)
+        {
+            CacheHierarchy *hierarchy = hierarchies[c];
+            for (const TraceAccess &access : trace)
+            {
+                if (access.is_write)
+                {
+                    hierarchy->write(access.address, access.data);
+                }
+                else
+                {
+                    hierarchy->read(access.address);
+                }
+            }
+        }
+    };
+
+    vector<thread> pool;
+    for (size_t t = 1; t < threads; t++)
+    {
+        pool.push_back(thread(worker));
+    }
+    worker();
+    for (thread &t : pool)
+    {
+        t.join();
+    }
+
+    return threads;
+}
+
+string CacheSweep::describe(const vector<LevelConfig> &levels)
+{
+    ostringstream out;
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        const LevelConfig &level = levels[i];
+        if (i > 0)
+        {
+            out << " / ";
+        }
+        out << level.size << "B " << level.block_size << "B " << level.associativity
+            << "-way " << replacementPolicyName(level.policy);
+        if (level.write_policy == WritePolicy::WRITE_BACK || level.miss_policy == WriteMissPolicy::WRITE_ALLOCATE)
+        {
+            out << (level.write_policy == WritePolicy::WRITE_BACK ? " wb" : " wt")
+                << (level.miss_policy == WriteMissPolicy::WRITE_ALLOCATE ? " wa" : " nwa");
+        }
+    }
+    return out.str();
+}
+
+void CacheSweep::printResults() const
+{
+    for (size_t c = 0; c < hierarchies.size(); c++)
+    {
+        const CacheHierarchy *hierarchy = hierarchies[c];
+
+        cout << "#" << c + 1 << "  " << describe(configs[c]) << endl;
+        cout << "    Hit ratio:";
+        for (size_t i = 0; i < hierarchy->getNumLevels(); i++)
+        {
+            cout << " L" << i + 1 << " " << fixed << setprecision(2)
+                 << hierarchy->getLevel(i)->getHitRatio() << "%";
+        }
+        cout << "   Memory: " << hierarchy->getMemoryReads() << " reads, "
+             << hierarchy->getMemoryWrites() << " writes"
+             << "   AMAT: " << fixed << setprecision(2)
+             << hierarchy->getLatencyStats().getAverage() << " cycles" << endl;
+    }
+}
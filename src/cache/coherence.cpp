@@ -0,0 +1,623 @@
+#include "../../include/coherence.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+const size_t MultiCoreHierarchy::MAX_CORES;
+
+// The shared level defaults to the latency of an L3, whatever its depth
+static const size_t SHARED_LEVEL_DEPTH = 2;
+
+MultiCoreHierarchy::MultiCoreHierarchy(size_t cores, size_t mem_size)
+    : num_cores(cores), block_size(0), protocol(CoherenceProtocol::MESI), private_levels(cores),
+      shared_level(nullptr), memory_size(mem_size), started(false),
+      shared_latency(CacheLevel::defaultHitLatency(SHARED_LEVEL_DEPTH)),
+      memory_latency(CacheHierarchy::DEFAULT_MEMORY_LATENCY), access_cycles(0),
+      core_stats(cores), core_latency(cores),
+      invalidations(0), false_sharing(0), transfers(0), writebacks(0), memory_reads(0), memory_writes(0)
+{
+}
+
+MultiCoreHierarchy::~MultiCoreHierarchy()
+{
+    for (auto &levels : private_levels)
+    {
+        for (CacheLevel *level : levels)
+        {
+            delete level;
+        }
+    }
+    delete shared_level;
+}
+
+bool MultiCoreHierarchy::addPrivateLevel(size_t size, size_t block_sz, size_t associativity,
+                                         ReplacementPolicy policy)
+{
+    // A new level below the others would start out violating inclusion
+    if (started)
+    {
+        cerr << "Error: Add private levels before the first access" << endl;
+        return false;
+    }
+
+    if (!CacheLevel::validGeometry(size, block_sz, associativity))
+    {
+        return false;
+    }
+
+    if (block_size != 0 && block_sz != block_size)
+    {
+        cerr << "Error: Every level of a multi-core hierarchy needs the same block size ("
+             << block_size << ")" << endl;
+        return false;
+    }
+
+    block_size = block_sz;
+    block_buffer.assign(block_size, 0);
+    for (size_t core = 0; core < num_cores; core++)
+    {
+        vector<CacheLevel *> &levels = private_levels[core];
+        levels.push_back(new CacheLevel(size, block_sz, associativity, policy));
+        levels.back()->setHitLatency(CacheLevel::defaultHitLatency(levels.size() - 1));
+    }
+    return true;
+}
+
+bool MultiCoreHierarchy::setSharedLevel(size_t size, size_t block_sz, size_t associativity,
+                                        ReplacementPolicy policy)
+{
+    if (shared_level != nullptr)
+    {
+        cerr << "Error: The shared level is already set" << endl;
+        return false;
+    }
+
+    if (started)
+    {
+        cerr << "Error: Add the shared level before the first access" << endl;
+        return false;
+    }
+
+    if (!CacheLevel::validGeometry(size, block_sz, associativity))
+    {
+        return false;
+    }
+
+    if (block_size != 0 && block_sz != block_size)
+    {
+        cerr << "Error: Every level of a multi-core hierarchy needs the same block size ("
+             << block_size << ")" << endl;
+        return false;
+    }
+
+    block_size = block_sz;
+    block_buffer.assign(block_size, 0);
+    shared_level = new CacheLevel(size, block_sz, associativity, policy,
+                                  WritePolicy::WRITE_BACK, WriteMissPolicy::WRITE_ALLOCATE);
+    shared_level->setHitLatency(shared_latency);
+    return true;
+}
+
+bool MultiCoreHierarchy::setProtocol(CoherenceProtocol p)
+{
+    // Switching from MOESI to MESI would leave blocks OWNED
+    if (started)
+    {
+        cerr << "Error: Set the protocol before the first access" << endl;
+        return false;
+    }
+
+    protocol = p;
+    return true;
+}
+
+bool MultiCoreHierarchy::setHitLatency(size_t level, uint64_t cycles)
+{
+    if (level >= getNumLevels())
+    {
+        cerr << "Error: Cache level L" << level + 1 << " does not exist" << endl;
+        return false;
+    }
+
+    if (level == getNumPrivateLevels())
+    {
+        shared_latency = cycles;
+        shared_level->setHitLatency(cycles);
+        return true;
+    }
+
+    for (vector<CacheLevel *> &levels : private_levels)
+    {
+        levels[level]->setHitLatency(cycles);
+    }
+    return true;
+}
+
+bool MultiCoreHierarchy::checkAccess(size_t core, size_t address) const
+{
+    if (private_levels[0].empty())
+    {
+        cerr << "Error: Add a private cache level first" << endl;
+        return false;
+    }
+
+    if (core >= num_cores)
+    {
+        cerr << "Error: Core " << core << " does not exist (cores 0-" << num_cores - 1 << ")" << endl;
+        return false;
+    }
+
+    if (address >= memory_size)
+    {
+        cerr << "Error: Address " << address << " out of bounds" << endl;
+        return false;
+    }
+    return true;
+}
+
+MultiCoreHierarchy::DirectoryEntry &MultiCoreHierarchy::entryFor(size_t base)
+{
+    auto it = directory.find(base);
+    if (it == directory.end())
+    {
+        it = directory.insert(make_pair(base, DirectoryEntry(num_cores))).first;
+    }
+    return it->second;
+}
+
+uint64_t MultiCoreHierarchy::wordBit(size_t address) const
+{
+    // Blocks of more than 64 words track groups of neighbouring words
+    size_t offset = address % block_size;
+    size_t bit = block_size <= 64 ? offset : offset * 64 / block_size;
+    return (uint64_t)1 << bit;
+}
+
+CoherenceState MultiCoreHierarchy::stateOf(const DirectoryEntry &entry, size_t core) const
+{
+    if ((entry.sharers & ((uint64_t)1 << core)) == 0)
+    {
+        return CoherenceState::INVALID;
+    }
+    return entry.owner == (int)core ? entry.owner_state : CoherenceState::SHARED;
+}
+
+CoherenceState MultiCoreHierarchy::getState(size_t core, size_t address) const
+{
+    if (core >= num_cores || block_size == 0)
+    {
+        return CoherenceState::INVALID;
+    }
+
+    auto it = directory.find(address - address % block_size);
+    return it == directory.end() ? CoherenceState::INVALID : stateOf(it->second, core);
+}
+
+int MultiCoreHierarchy::lookupPrivate(size_t core, size_t address)
+{
+    vector<CacheLevel *> &levels = private_levels[core];
+    size_t data;
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        access_cycles += levels[i]->getHitLatency();
+        if (levels[i]->access(address, data))
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void MultiCoreHierarchy::fillAbove(size_t core, size_t level, size_t base)
+{
+    // Copy a block that hit in a lower private level into the levels above
+    // it; their victims are still in the last level, so they are dropped
+    vector<CacheLevel *> &levels = private_levels[core];
+    levels[level]->readWords(base, block_buffer.data(), block_size);
+    for (size_t i = level; i-- > 0;)
+    {
+        levels[i]->insert(base, block_buffer.data());
+    }
+}
+
+void MultiCoreHierarchy::fillPrivate(size_t core, size_t base, const size_t *block)
+{
+    // Deepest level first, so an eviction there can back-invalidate the
+    // levels above before they are filled
+    vector<CacheLevel *> &levels = private_levels[core];
+    EvictedLine victim;
+    levels.back()->insert(base, block, false, &victim);
+    if (victim.valid)
+    {
+        leaveCore(core, victim);
+    }
+
+    for (size_t i = levels.size() - 1; i-- > 0;)
+    {
+        levels[i]->insert(base, block);
+    }
+}
+
+void MultiCoreHierarchy::leaveCore(size_t core, EvictedLine &line)
+{
+    vector<CacheLevel *> &levels = private_levels[core];
+    for (size_t i = 0; i + 1 < levels.size(); i++)
+    {
+        levels[i]->invalidate(line.address);
+    }
+
+    DirectoryEntry &entry = entryFor(line.address);
+    CoherenceState state = stateOf(entry, core);
+    if (state == CoherenceState::MODIFIED || state == CoherenceState::OWNED)
+    {
+        writeShared(line.address, line.data.data());
+        core_stats[core].writebacks++;
+    }
+
+    entry.sharers &= ~((uint64_t)1 << core);
+    if (entry.owner == (int)core)
+    {
+        // Any remaining sharers of an owned block now read the shared level
+        entry.owner = -1;
+        entry.owner_state = CoherenceState::INVALID;
+    }
+}
+
+void MultiCoreHierarchy::readShared(size_t base, size_t *block)
+{
+    size_t data;
+    if (shared_level != nullptr && shared_level->access(base, data))
+    {
+        shared_level->readWords(base, block, block_size);
+        return;
+    }
+
+    main_memory.readBlock(base, block, block_size);
+    memory_reads++;
+    access_cycles += memory_latency;
+
+    if (shared_level != nullptr)
+    {
+        EvictedLine victim;
+        shared_level->insert(base, block, false, &victim);
+        if (victim.valid && victim.dirty)
+        {
+            main_memory.writeBlock(victim.address, victim.data.data(), block_size);
+            memory_writes++;
+        }
+    }
+}
+
+void MultiCoreHierarchy::writeShared(size_t base, const size_t *block)
+{
+    writebacks++;
+    if (shared_level == nullptr)
+    {
+        main_memory.writeBlock(base, block, block_size);
+        memory_writes++;
+        return;
+    }
+
+    if (shared_level->update(base, block, block_size, true))
+    {
+        return;
+    }
+
+    EvictedLine victim;
+    shared_level->insert(base, block, true, &victim);
+    if (victim.valid && victim.dirty)
+    {
+        main_memory.writeBlock(victim.address, victim.data.data(), block_size);
+        memory_writes++;
+    }
+}
+
+void MultiCoreHierarchy::supply(DirectoryEntry &entry, size_t to_core, size_t base, size_t *block)
+{
+    // The block's current data: from a dirty owner's caches if there is
+    // one, otherwise from the shared level or memory
+    if (entry.owner >= 0 && entry.owner != (int)to_core &&
+        (entry.owner_state == CoherenceState::MODIFIED || entry.owner_state == CoherenceState::OWNED))
+    {
+        size_t owner = entry.owner;
+        private_levels[owner].back()->readWords(base, block, block_size);
+        entry.transfers++;
+        transfers++;
+        core_stats[owner].transfers_supplied++;
+        core_stats[to_core].transfers_received++;
+        return;
+    }
+    readShared(base, block);
+}
+
+void MultiCoreHierarchy::invalidateOthers(DirectoryEntry &entry, size_t core, size_t base, uint64_t word)
+{
+    for (size_t other = 0; other < num_cores; other++)
+    {
+        if (other == core || (entry.sharers & ((uint64_t)1 << other)) == 0)
+        {
+            continue;
+        }
+
+        for (CacheLevel *level : private_levels[other])
+        {
+            level->invalidate(base);
+        }
+
+        entry.invalidations++;
+        invalidations++;
+        core_stats[other].invalidations++;
+        if ((entry.touched[other] & word) == 0)
+        {
+            entry.false_sharing++;
+            false_sharing++;
+        }
+    }
+
+    // The writer's copy is current, so a dirty owner's data is not needed
+    entry.sharers &= (uint64_t)1 << core;
+}
+
+bool MultiCoreHierarchy::read(size_t core, size_t address, size_t &data)
+{
+    if (!checkAccess(core, address))
+    {
+        return false;
+    }
+
+    started = true;
+    access_cycles = 0;
+    core_stats[core].reads++;
+
+    size_t base = address - address % block_size;
+    DirectoryEntry &entry = entryFor(base);
+    uint64_t bit = (uint64_t)1 << core;
+
+    int level = lookupPrivate(core, address);
+    if (level > 0)
+    {
+        fillAbove(core, level, base);
+    }
+    else if (level < 0)
+    {
+        core_stats[core].read_requests++;
+        access_cycles += shared_latency;
+        supply(entry, core, base, block_buffer.data());
+
+        if (entry.owner >= 0)
+        {
+            // The owner keeps a copy: E becomes S, M becomes S after writing
+            // back (MESI) or stays dirty as O (MOESI); O stays O
+            if (entry.owner_state == CoherenceState::EXCLUSIVE)
+            {
+                entry.owner = -1;
+            }
+            else if (entry.owner_state == CoherenceState::MODIFIED)
+            {
+                if (protocol == CoherenceProtocol::MOESI)
+                {
+                    entry.owner_state = CoherenceState::OWNED;
+                }
+                else
+                {
+                    writeShared(base, block_buffer.data());
+                    core_stats[entry.owner].writebacks++;
+                    entry.owner = -1;
+                }
+            }
+            if (entry.owner < 0)
+            {
+                entry.owner_state = CoherenceState::INVALID;
+            }
+        }
+
+        if (entry.sharers == 0)
+        {
+            entry.owner = core;
+            entry.owner_state = CoherenceState::EXCLUSIVE;
+        }
+        entry.sharers |= bit;
+        entry.touched[core] = 0;
+        fillPrivate(core, base, block_buffer.data());
+    }
+
+    entry.touched[core] |= wordBit(address);
+    entry.accessed_by |= bit;
+    private_levels[core][0]->readWords(address, &data, 1);
+    core_latency[core].record(access_cycles);
+    return true;
+}
+
+bool MultiCoreHierarchy::write(size_t core, size_t address, size_t data)
+{
+    if (!checkAccess(core, address))
+    {
+        return false;
+    }
+
+    started = true;
+    access_cycles = 0;
+    core_stats[core].writes++;
+
+    size_t base = address - address % block_size;
+    DirectoryEntry &entry = entryFor(base);
+    uint64_t bit = (uint64_t)1 << core;
+    uint64_t word = wordBit(address);
+
+    int level = lookupPrivate(core, address);
+    if (level >= 0)
+    {
+        CoherenceState state = stateOf(entry, core);
+        if (state == CoherenceState::SHARED || state == CoherenceState::OWNED)
+        {
+            core_stats[core].upgrades++;
+            access_cycles += shared_latency;
+            invalidateOthers(entry, core, base, word);
+        }
+        if (level > 0)
+        {
+            fillAbove(core, level, base);
+        }
+    }
+    else
+    {
+        core_stats[core].write_requests++;
+        access_cycles += shared_latency;
+        supply(entry, core, base, block_buffer.data());
+        invalidateOthers(entry, core, base, word);
+        entry.sharers = bit;
+        entry.touched[core] = 0;
+        fillPrivate(core, base, block_buffer.data());
+    }
+
+    entry.owner = core;
+    entry.owner_state = CoherenceState::MODIFIED;
+    entry.touched[core] |= word;
+    entry.accessed_by |= bit;
+
+    for (CacheLevel *private_level : private_levels[core])
+    {
+        private_level->update(address, &data, 1, false);
+    }
+    core_latency[core].record(access_cycles);
+    return true;
+}
+
+bool MultiCoreHierarchy::replay(const vector<CoreAccess> &trace)
+{
+    for (const CoreAccess &access : trace)
+    {
+        if (!checkAccess(access.core, access.access.address))
+        {
+            return false;
+        }
+    }
+
+    size_t data;
+    for (const CoreAccess &access : trace)
+    {
+        if (access.access.is_write)
+        {
+            write(access.core, access.access.address, access.access.data);
+        }
+        else
+        {
+            read(access.core, access.access.address, data);
+        }
+    }
+    return true;
+}
+
+void MultiCoreHierarchy::printAllStats()
+{
+    cout << "\n=== Multi-core Hierarchy Statistics ===" << endl;
+    cout << "Cores: " << num_cores << ", protocol: "
+         << (protocol == CoherenceProtocol::MESI ? "MESI" : "MOESI") << endl;
+
+    for (size_t core = 0; core < num_cores; core++)
+    {
+        const CoreCoherenceStats &stats = core_stats[core];
+        cout << "\n--- Core " << core << " ---" << endl;
+        for (size_t i = 0; i < private_levels[core].size(); i++)
+        {
+            private_levels[core][i]->printStats("Core " + to_string(core) + " L" + to_string(i + 1));
+        }
+        cout << "Accesses: " << stats.reads << " reads, " << stats.writes << " writes" << endl;
+        cout << "Bus Requests: " << stats.read_requests << " GetS, " << stats.write_requests
+             << " GetM, " << stats.upgrades << " upgrades" << endl;
+        cout << "Invalidations Received: " << stats.invalidations << endl;
+        cout << "Cache-to-cache Transfers: " << stats.transfers_supplied << " supplied, "
+             << stats.transfers_received << " received" << endl;
+        cout << "Writebacks: " << stats.writebacks << endl;
+        cout << "Average Memory Access Time: " << fixed << setprecision(2)
+             << core_latency[core].getAverage() << " cycles" << endl;
+    }
+
+    cout << "\n--- Shared Level ---" << endl;
+    if (shared_level != nullptr)
+    {
+        shared_level->printStats("Shared L" + to_string(private_levels[0].size() + 1));
+    }
+    else
+    {
+        cout << "None (private misses go to memory)" << endl;
+    }
+
+    uint64_t bus_transactions = 0;
+    for (const CoreCoherenceStats &stats : core_stats)
+    {
+        bus_transactions += stats.read_requests + stats.write_requests + stats.upgrades;
+    }
+    double false_ratio = invalidations > 0 ? (100.0 * false_sharing / invalidations) : 0.0;
+
+    cout << "\nCoherence Traffic:" << endl;
+    cout << "  Bus Transactions: " << bus_transactions << endl;
+    cout << "  Invalidations: " << invalidations << " (" << false_sharing << " false sharing, "
+         << fixed << setprecision(2) << false_ratio << "%)" << endl;
+    cout << "  Cache-to-cache Transfers: " << transfers << endl;
+    cout << "  Writebacks to Shared Level: " << writebacks << endl;
+    cout << "  Blocks Tracked: " << directory.size() << endl;
+    cout << "Main Memory Traffic:" << endl;
+    cout << "  Reads: " << memory_reads << endl;
+    cout << "  Writes: " << memory_writes << endl;
+    cout << "  Latency: " << memory_latency << " cycles" << endl;
+
+    LatencyStats all;
+    for (const LatencyStats &stats : core_latency)
+    {
+        all.merge(stats);
+    }
+    cout << "Average Memory Access Time: " << fixed << setprecision(2)
+         << all.getAverage() << " cycles (" << all.getAccesses() << " accesses)" << endl;
+}
+
+void MultiCoreHierarchy::printHotspots(size_t count)
+{
+    // Blocks ranked by the coherence traffic they caused
+    vector<pair<uint64_t, size_t>> ranked;
+    for (const auto &item : directory)
+    {
+        uint64_t traffic = item.second.invalidations + item.second.transfers;
+        if (traffic > 0)
+        {
+            ranked.push_back(make_pair(traffic, item.first));
+        }
+    }
+
+    sort(ranked.begin(), ranked.end(), [](const pair<uint64_t, size_t> &a, const pair<uint64_t, size_t> &b)
+         { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+
+    cout << "\n=== Coherence Hotspots ===" << endl;
+    if (ranked.empty())
+    {
+        cout << "No block caused invalidations or transfers" << endl;
+        return;
+    }
+
+    cout << setfill(' ') << left << setw(22) << "Block" << right << setw(8) << "Cores"
+         << setw(15) << "Invalidations" << setw(15) << "False Sharing" << setw(12) << "Transfers" << endl;
+
+    for (size_t i = 0; i < ranked.size() && i < count; i++)
+    {
+        size_t base = ranked[i].second;
+        const DirectoryEntry &entry = directory.at(base);
+
+        size_t cores = 0;
+        for (uint64_t mask = entry.accessed_by; mask != 0; mask &= mask - 1)
+        {
+            cores++;
+        }
+
+        string range = to_string(base) + "-" + to_string(base + block_size - 1);
+        cout << left << setw(22) << range << right << setw(8) << cores
+             << setw(15) << entry.invalidations << setw(15) << entry.false_sharing
+             << setw(12) << entry.transfers << endl;
+    }
+
+    if (ranked.size() > count)
+    {
+        cout << "(" << ranked.size() - count << " more blocks)" << endl;
+    }
+}
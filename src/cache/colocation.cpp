@@ -0,0 +1,427 @@
+#include "../../include/colocation.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+using namespace std;
+
+const size_t Colocation::MAX_THREADS;
+
+double ThreadRunStats::getHitRatio(size_t level) const
+{
+    uint64_t total = level_hits[level] + level_misses[level];
+    return total > 0 ? (100.0 * level_hits[level] / total) : 0.0;
+}
+
+double ThreadRunStats::getAverageCycles() const
+{
+    return accesses > 0 ? (double)cycles / accesses : 0.0;
+}
+
+Colocation::Colocation(size_t virt_bits, size_t phys_bits, size_t page_sz, PageReplacementPolicy policy)
+    : virtual_bits(virt_bits), physical_bits(phys_bits), page_size(page_sz), page_policy(policy),
+      shared_latency(0), interleave(InterleavePolicy::ROUND_ROBIN)
+{
+}
+
+CacheHierarchy *Colocation::buildHierarchy(const vector<LevelConfig> &config) const
+{
+    CacheHierarchy *hierarchy = new CacheHierarchy((size_t)1 << physical_bits);
+    for (const LevelConfig &level : config)
+    {
+        if (!hierarchy->addLevel(level.size, level.block_size, level.associativity, level.policy,
+                                 level.write_policy, level.miss_policy))
+        {
+            delete hierarchy;
+            return nullptr;
+        }
+    }
+    return hierarchy;
+}
+
+bool Colocation::addLevel(const LevelConfig &level)
+{
+    // Build the hierarchy once here so an invalid level is reported now
+    vector<LevelConfig> config = levels;
+    config.push_back(level);
+    CacheHierarchy *hierarchy = buildHierarchy(config);
+    if (hierarchy == nullptr)
+    {
+        return false;
+    }
+
+    // The shared level keeps the latency of its place in the full stack
+    shared_latency = hierarchy->getLevel(config.size() - 1)->getHitLatency();
+    delete hierarchy;
+
+    levels.push_back(level);
+    return true;
+}
+
+bool Colocation::addThread(const string &path, size_t weight)
+{
+    if (threads.size() == MAX_THREADS)
+    {
+        cerr << "Error: At most " << MAX_THREADS << " threads can be co-located" << endl;
+        return false;
+    }
+
+    if (weight == 0)
+    {
+        cerr << "Error: Thread weight must be at least 1" << endl;
+        return false;
+    }
+
+    if (!ifstream(path))
+    {
+        cerr << "Error: Cannot open trace file " << path << endl;
+        return false;
+    }
+
+    ThreadTrace trace;
+    trace.path = path;
+    trace.weight = weight;
+    threads.push_back(trace);
+    return true;
+}
+
+bool Colocation::loadThreads(InterleavePolicy policy, vector<vector<size_t>> &times)
+{
+    // Traces are read at run time: the interleaving decides their format
+    times.assign(threads.size(), vector<size_t>());
+    size_t virtual_size = (size_t)1 << virtual_bits;
+
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        ThreadTrace &thread = threads[t];
+        if (policy == InterleavePolicy::TIMESTAMP)
+        {
+            vector<TimedAccess> timed;
+            if (!loadTimedTrace(thread.path, timed))
+            {
+                return false;
+            }
+            thread.accesses.clear();
+            for (const TimedAccess &access : timed)
+            {
+                times[t].push_back(access.time);
+                thread.accesses.push_back(access.access);
+            }
+        }
+        else if (!loadTrace(thread.path, thread.accesses))
+        {
+            return false;
+        }
+
+        for (const TraceAccess &access : thread.accesses)
+        {
+            if (access.address >= virtual_size)
+            {
+                cerr << "Error: " << thread.path << ": address " << access.address
+                     << " is outside the virtual address space" << endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Colocation::buildSchedule(InterleavePolicy policy, const vector<vector<size_t>> &times)
+{
+    schedule.clear();
+    vector<size_t> next(threads.size(), 0);
+    size_t remaining = 0;
+    for (const ThreadTrace &thread : threads)
+    {
+        remaining += thread.accesses.size();
+    }
+
+    while (remaining > 0)
+    {
+        if (policy == InterleavePolicy::TIMESTAMP)
+        {
+            // Earliest head of any trace; ties go to the lower thread
+            size_t pick = threads.size();
+            for (size_t t = 0; t < threads.size(); t++)
+            {
+                if (next[t] < threads[t].accesses.size() &&
+                    (pick == threads.size() || times[t][next[t]] < times[pick][next[pick]]))
+                {
+                    pick = t;
+                }
+            }
+            schedule.push_back(make_pair(pick, next[pick]++));
+            remaining--;
+            continue;
+        }
+
+        // One round: each unfinished thread issues its share in turn
+        for (size_t t = 0; t < threads.size(); t++)
+        {
+            size_t share = policy == InterleavePolicy::WEIGHTED ? threads[t].weight : 1;
+            for (size_t i = 0; i < share && next[t] < threads[t].accesses.size(); i++)
+            {
+                schedule.push_back(make_pair(t, next[t]++));
+                remaining--;
+            }
+        }
+    }
+}
+
+vector<ThreadRunStats> Colocation::simulate(uint64_t members) const
+{
+    VirtualMemory vm(virtual_bits, physical_bits, page_size, page_policy, threads.size(), false);
+    size_t num_levels = levels.size();
+    size_t last = num_levels - 1;
+
+    // Each thread gets its own copy of the levels above the last one, all
+    // backed by the one shared last level
+    CacheHierarchy *shared_level = buildHierarchy(vector<LevelConfig>(1, levels[last]));
+    shared_level->setHitLatency(0, shared_latency);
+    vector<CacheHierarchy *> hierarchies(threads.size(), shared_level);
+    if (last > 0)
+    {
+        vector<LevelConfig> upper(levels.begin(), levels.begin() + last);
+        for (size_t t = 0; t < threads.size(); t++)
+        {
+            if ((members & ((uint64_t)1 << t)) != 0)
+            {
+                hierarchies[t] = buildHierarchy(upper);
+                hierarchies[t]->setBackingHierarchy(shared_level);
+            }
+        }
+    }
+    auto level = [&](size_t t, size_t i) -> const CacheLevel *
+    {
+        return i < last ? hierarchies[t]->getLevel(i) : shared_level->getLevel(0);
+    };
+
+    ThreadRunStats empty = {0, vector<uint64_t>(num_levels, 0), vector<uint64_t>(num_levels, 0), 0, 0};
+    vector<ThreadRunStats> stats(threads.size(), empty);
+    vector<uint64_t> hits_before(num_levels), misses_before(num_levels);
+
+    for (const pair<size_t, size_t> &slot : schedule)
+    {
+        size_t t = slot.first;
+        if ((members & ((uint64_t)1 << t)) == 0)
+        {
+            continue;
+        }
+
+        const TraceAccess &access = threads[t].accesses[slot.second];
+        CacheHierarchy *hierarchy = hierarchies[t];
+        for (size_t i = 0; i < num_levels; i++)
+        {
+            hits_before[i] = level(t, i)->getHits();
+            misses_before[i] = level(t, i)->getMisses();
+        }
+        uint64_t faults_before = vm.getPageFaults();
+
+        size_t physical = vm.translate(access.address, t);
+        if (access.is_write)
+        {
+            hierarchy->write(physical, access.data);
+        }
+        else
+        {
+            hierarchy->read(physical);
+        }
+
+        ThreadRunStats &thread = stats[t];
+        thread.accesses++;
+        thread.page_faults += vm.getPageFaults() - faults_before;
+        thread.cycles += vm.getLastTranslationCycles() + hierarchy->getLastAccessCycles();
+        for (size_t i = 0; i < num_levels; i++)
+        {
+            thread.level_hits[i] += level(t, i)->getHits() - hits_before[i];
+            thread.level_misses[i] += level(t, i)->getMisses() - misses_before[i];
+        }
+    }
+
+    for (CacheHierarchy *hierarchy : hierarchies)
+    {
+        if (hierarchy != shared_level)
+        {
+            delete hierarchy;
+        }
+    }
+    delete shared_level;
+    return stats;
+}
+
+bool Colocation::run(InterleavePolicy policy, size_t workers)
+{
+    if (levels.empty())
+    {
+        cerr << "Error: Add a cache level first" << endl;
+        return false;
+    }
+
+    if (threads.empty())
+    {
+        cerr << "Error: Add a thread first" << endl;
+        return false;
+    }
+
+    vector<vector<size_t>> times;
+    if (!loadThreads(policy, times))
+    {
+        return false;
+    }
+
+    interleave = policy;
+    buildSchedule(policy, times);
+
+    // Run 0 is the full mix; with company, runs 1..n are each thread alone
+    // and runs n+1..2n the mix without each thread
+    size_t n = threads.size();
+    uint64_t all = n == MAX_THREADS ? ~(uint64_t)0 : ((uint64_t)1 << n) - 1;
+    vector<uint64_t> runs(1, all);
+    if (n > 1)
+    {
+        for (size_t t = 0; t < n; t++)
+        {
+            runs.push_back((uint64_t)1 << t);
+        }
+        for (size_t t = 0; t < n; t++)
+        {
+            runs.push_back(all & ~((uint64_t)1 << t));
+        }
+    }
+
+    vector<vector<ThreadRunStats>> results(runs.size());
+    if (workers == 0)
+    {
+        workers = thread::hardware_concurrency();
+    }
+    workers = max((size_t)1, min(workers, runs.size()));
+
+    atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for (size_t r = next++; r < runs.size(); r = next++)
+        {
+            results[r] = simulate(runs[r]);
+        }
+    };
+
+    vector<thread> pool;
+    for (size_t w = 1; w < workers; w++)
+    {
+        pool.push_back(thread(worker));
+    }
+    worker();
+    for (thread &w : pool)
+    {
+        w.join();
+    }
+
+    shared = results[0];
+    solo.clear();
+    without.clear();
+    if (n > 1)
+    {
+        for (size_t t = 0; t < n; t++)
+        {
+            solo.push_back(results[1 + t][t]);
+            without.push_back(results[1 + n + t]);
+        }
+    }
+    else
+    {
+        solo = shared;
+    }
+    return true;
+}
+
+void Colocation::printResults() const
+{
+    const char *names[] = {"round-robin", "weighted", "timestamp"};
+    size_t n = threads.size();
+    size_t last = levels.size() - 1;
+
+    cout << "\n=== Co-location: " << n << " threads, " << names[(int)interleave] << " ===" << endl;
+    cout << "Cache: " << CacheSweep::describe(levels);
+    cout << (levels.size() > 1 ? ", last level shared" : ", shared") << endl;
+    cout << "Frames: " << ((size_t)1 << physical_bits) / page_size << " of " << page_size
+         << " bytes, shared by all threads" << endl;
+
+    for (size_t t = 0; t < n; t++)
+    {
+        const ThreadRunStats &with = shared[t];
+        const ThreadRunStats &alone = solo[t];
+
+        cout << "\nThread " << t << " (" << threads[t].path;
+        if (interleave == InterleavePolicy::WEIGHTED)
+        {
+            cout << ", weight " << threads[t].weight;
+        }
+        cout << "): " << with.accesses << " accesses" << endl;
+
+        const ThreadRunStats *runs[] = {&with, &alone};
+        const char *labels[] = {"  Shared:", "  Alone: "};
+        for (size_t r = 0; r < 2; r++)
+        {
+            cout << labels[r];
+            for (size_t i = 0; i <= last; i++)
+            {
+                cout << " L" << i + 1 << " " << fixed << setprecision(2) << runs[r]->getHitRatio(i) << "%";
+            }
+            cout << "   Page faults: " << runs[r]->page_faults
+                 << "   AMAT: " << fixed << setprecision(2) << runs[r]->getAverageCycles() << " cycles" << endl;
+        }
+
+        double slowdown = alone.cycles > 0 ? (double)with.cycles / alone.cycles : 1.0;
+        cout << "  Slowdown: " << fixed << setprecision(2) << slowdown << "x   vs alone: L" << last + 1
+             << " misses " << showpos << (long long)(with.level_misses[last] - alone.level_misses[last])
+             << ", page faults " << (long long)(with.page_faults - alone.page_faults) << noshowpos << endl;
+    }
+
+    if (n < 2)
+    {
+        return;
+    }
+
+    // Row i, column j: what thread i's presence adds to thread j
+    for (size_t table = 0; table < 2; table++)
+    {
+        if (table == 0)
+        {
+            cout << "\nInterference: extra L" << last + 1 << " misses caused (row) to each thread (column)" << endl;
+        }
+        else
+        {
+            cout << "\nInterference: extra page faults caused (row) to each thread (column)" << endl;
+        }
+
+        cout << setfill(' ') << setw(8) << "";
+        for (size_t j = 0; j < n; j++)
+        {
+            cout << setw(10) << ("T" + to_string(j));
+        }
+        cout << setw(10) << "Total" << endl;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            cout << setw(8) << ("T" + to_string(i));
+            long long total = 0;
+            for (size_t j = 0; j < n; j++)
+            {
+                if (i == j)
+                {
+                    cout << setw(10) << "-";
+                    continue;
+                }
+                long long extra = table == 0
+                                      ? (long long)(shared[j].level_misses[last] - without[i][j].level_misses[last])
+                                      : (long long)(shared[j].page_faults - without[i][j].page_faults);
+                total += extra;
+                cout << setw(10) << extra;
+            }
+            cout << setw(10) << total << endl;
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#include "../../include/latency_stats.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+const size_t LatencyStats::NUM_BUCKETS;
+
+LatencyStats::LatencyStats()
+{
+    reset();
+}
+
+void LatencyStats::reset()
+{
+    accesses = 0;
+    total_cycles = 0;
+    max_cycles = 0;
+    for (size_t b = 0; b < NUM_BUCKETS; b++)
+    {
+        buckets[b] = 0;
+    }
+}
+
+void LatencyStats::record(uint64_t cycles)
+{
+    accesses++;
+    total_cycles += cycles;
+    if (cycles > max_cycles)
+    {
+        max_cycles = cycles;
+    }
+
+    size_t bucket = cycles == 0 ? 0 : 64 - __builtin_clzll(cycles);
+    if (bucket >= NUM_BUCKETS)
+    {
+        bucket = NUM_BUCKETS - 1;
+    }
+    buckets[bucket]++;
+}
+
+void LatencyStats::merge(const LatencyStats &other)
+{
+    accesses += other.accesses;
+    total_cycles += other.total_cycles;
+    max_cycles = max(max_cycles, other.max_cycles);
+    for (size_t b = 0; b < NUM_BUCKETS; b++)
+    {
+        buckets[b] += other.buckets[b];
+    }
+}
+
+double LatencyStats::getAverage() const
+{
+    return accesses > 0 ? (double)total_cycles / accesses : 0.0;
+}
+
+void LatencyStats::printHistogram() const
+{
+    const size_t bar_width = 40;
+
+    uint64_t peak = 0;
+    size_t first = NUM_BUCKETS, last = 0;
+    for (size_t b = 0; b < NUM_BUCKETS; b++)
+    {
+        if (buckets[b] == 0)
+        {
+            continue;
+        }
+        if (first == NUM_BUCKETS)
+        {
+            first = b;
+        }
+        last = b;
+        if (buckets[b] > peak)
+        {
+            peak = buckets[b];
+        }
+    }
+
+    cout << "Latency histogram (cycles):" << endl;
+    if (peak == 0)
+    {
+        cout << "  (no accesses)" << endl;
+        return;
+    }
+
+    for (size_t b = first; b <= last; b++)
+    {
+        string range;
+        if (b == 0)
+        {
+            range = "0";
+        }
+        else
+        {
+            uint64_t low = (uint64_t)1 << (b - 1);
+            uint64_t high = (low << 1) - 1;
+            range = low == high ? to_string(low) : to_string(low) + "-" + to_string(high);
+        }
+
+        size_t bar = (size_t)((buckets[b] * bar_width + peak - 1) / peak);
+        cout << "  " << setw(13) << range << " | " << setw(8) << buckets[b];
+        if (bar > 0)
+        {
+            cout << " " << string(bar, '#');
+        }
+        cout << endl;
+    }
+}
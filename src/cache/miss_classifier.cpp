@@ -0,0 +1,146 @@
+#include "../../include/miss_classifier.h"
+
+using namespace std;
+
+const uint32_t MissClassifier::NONE;
+const size_t MissClassifier::EMPTY_KEY;
+
+MissClassifier::MissClassifier(size_t lines)
+    : capacity(lines), used(0), entries(0), hash_shift(64), head(NONE), tail(NONE)
+{
+    slot_block.assign(lines, 0);
+    next_slot.assign(lines, NONE);
+    prev_slot.assign(lines, NONE);
+
+    if (lines > 0)
+    {
+        // Room for twice the shadow cache before the first doubling
+        size_t table_size = 16;
+        hash_shift = 60;
+        while (table_size < 4 * lines)
+        {
+            table_size *= 2;
+            hash_shift--;
+        }
+        keys.assign(table_size, EMPTY_KEY);
+        slot_of.assign(table_size, NONE);
+    }
+}
+
+size_t MissClassifier::findEntry(size_t block) const
+{
+    // Fibonacci hashing spreads consecutive block numbers over the table;
+    // the result is the block's entry or the empty one it would take
+    size_t mask = keys.size() - 1;
+    size_t i = (size_t)(((uint64_t)block * 0x9E3779B97F4A7C15ull) >> hash_shift);
+    while (keys[i] != block && keys[i] != EMPTY_KEY)
+    {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void MissClassifier::growTable()
+{
+    vector<size_t> old_keys;
+    vector<uint32_t> old_slots;
+    old_keys.swap(keys);
+    old_slots.swap(slot_of);
+    keys.assign(old_keys.size() * 2, EMPTY_KEY);
+    slot_of.assign(old_slots.size() * 2, NONE);
+    hash_shift--;
+
+    for (size_t i = 0; i < old_keys.size(); i++)
+    {
+        if (old_keys[i] != EMPTY_KEY)
+        {
+            size_t j = findEntry(old_keys[i]);
+            keys[j] = old_keys[i];
+            slot_of[j] = old_slots[i];
+        }
+    }
+}
+
+void MissClassifier::pushFront(uint32_t slot)
+{
+    prev_slot[slot] = NONE;
+    next_slot[slot] = head;
+
+    if (head != NONE)
+        prev_slot[head] = slot;
+    else
+        tail = slot;
+
+    head = slot;
+}
+
+void MissClassifier::unlink(uint32_t slot)
+{
+    uint32_t prev = prev_slot[slot];
+    uint32_t next = next_slot[slot];
+
+    if (prev != NONE)
+        next_slot[prev] = next;
+    else
+        head = next;
+
+    if (next != NONE)
+        prev_slot[next] = prev;
+    else
+        tail = prev;
+}
+
+uint32_t MissClassifier::admit(size_t block)
+{
+    // Take a free slot while there is one, then the least recently used
+    uint32_t slot;
+    if (used < capacity)
+    {
+        slot = used++;
+    }
+    else
+    {
+        slot = tail;
+        unlink(slot);
+        slot_of[findEntry(slot_block[slot])] = NONE;
+    }
+
+    slot_block[slot] = block;
+    pushFront(slot);
+    return slot;
+}
+
+MissType MissClassifier::reference(size_t block, bool allocate)
+{
+    // One lookup serves both the first-touch check and the shadow cache
+    size_t index = findEntry(block);
+    bool first_touch = keys[index] == EMPTY_KEY;
+    if (first_touch)
+    {
+        if (2 * (entries + 1) > keys.size())
+        {
+            growTable();
+            index = findEntry(block);
+        }
+        keys[index] = block;
+        entries++;
+    }
+    uint32_t &slot = slot_of[index];
+
+    if (slot != NONE)
+    {
+        if (slot != head)
+        {
+            unlink(slot);
+            pushFront(slot);
+        }
+        return MissType::CONFLICT;
+    }
+
+    // admit() only looks up other blocks, so `slot` stays valid
+    if (allocate)
+    {
+        slot = admit(block);
+    }
+    return first_touch ? MissType::COMPULSORY : MissType::CAPACITY;
+}
@@ -0,0 +1,64 @@
+#include "../../include/mshr.h"
+#include <algorithm>
+
+using namespace std;
+
+MSHRFile::MSHRFile(size_t entries)
+    : blocks(entries, 0), ready(entries, 0), primary_misses(0), merged_misses(0),
+      full_stalls(0), peak_occupancy(0), occupied_cycles(0), busy_cycles(0), busy_until(0)
+{
+}
+
+bool MSHRFile::findPending(size_t block, uint64_t now, uint64_t &fill_ready) const
+{
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        if (ready[i] > now && blocks[i] == block)
+        {
+            fill_ready = ready[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t MSHRFile::nextFree(uint64_t now) const
+{
+    uint64_t earliest = ready.empty() ? now : *min_element(ready.begin(), ready.end());
+    return max(earliest, now);
+}
+
+void MSHRFile::allocate(size_t block, uint64_t start, uint64_t fill_ready)
+{
+    size_t slot = blocks.size();
+    size_t held = 1;
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        if (ready[i] > start)
+        {
+            held++;
+        }
+        else if (slot == blocks.size())
+        {
+            slot = i;
+        }
+    }
+
+    blocks[slot] = block;
+    ready[slot] = fill_ready;
+    primary_misses++;
+    peak_occupancy = max(peak_occupancy, held);
+
+    // Start cycles never decrease, so the busy time is a running union
+    occupied_cycles += fill_ready - start;
+    if (fill_ready > busy_until)
+    {
+        busy_cycles += fill_ready - max(start, busy_until);
+        busy_until = fill_ready;
+    }
+}
+
+double MSHRFile::getParallelism() const
+{
+    return busy_cycles > 0 ? (double)occupied_cycles / busy_cycles : 0.0;
+}
@@ -0,0 +1,154 @@
+#include "../../include/prefetcher.h"
+
+using namespace std;
+
+const size_t Prefetcher::NUM_STREAMS;
+
+Prefetcher::Prefetcher(PrefetcherType t, size_t deg, size_t dist, size_t lat)
+    : type(t), degree(deg), distance(dist), latency(lat),
+      has_last(false), last_block(0), last_stride(0), confidence(0),
+      stream_clock(0)
+{
+    if (type == PrefetcherType::STREAM)
+    {
+        Stream empty = {false, 0, 0, 0};
+        streams.assign(NUM_STREAMS, empty);
+    }
+}
+
+const char *Prefetcher::getName() const
+{
+    switch (type)
+    {
+    case PrefetcherType::NEXT_LINE:
+        return "next-line";
+    case PrefetcherType::STRIDE:
+        return "stride";
+    case PrefetcherType::STREAM:
+        return "stream";
+    }
+    return "unknown";
+}
+
+void Prefetcher::issueAlong(size_t block, long long stride, vector<size_t> &candidates) const
+{
+    for (size_t k = 0; k < degree; k++)
+    {
+        long long target = (long long)block + stride * (long long)(distance + k);
+        if (target < 0)
+        {
+            break;
+        }
+        candidates.push_back((size_t)target);
+    }
+}
+
+void Prefetcher::observe(size_t block, bool trigger, vector<size_t> &candidates)
+{
+    switch (type)
+    {
+    case PrefetcherType::NEXT_LINE:
+        if (trigger)
+        {
+            issueAlong(block, 1, candidates);
+        }
+        break;
+
+    case PrefetcherType::STRIDE:
+        trainStride(block, candidates);
+        break;
+
+    case PrefetcherType::STREAM:
+        if (trigger)
+        {
+            trainStream(block, candidates);
+        }
+        break;
+    }
+}
+
+void Prefetcher::trainStride(size_t block, vector<size_t> &candidates)
+{
+    if (!has_last)
+    {
+        has_last = true;
+        last_block = block;
+        return;
+    }
+
+    long long stride = (long long)block - (long long)last_block;
+    last_block = block;
+
+    // Repeated accesses to one block say nothing about the stride
+    if (stride == 0)
+    {
+        return;
+    }
+
+    if (stride == last_stride)
+    {
+        if (confidence < 2)
+        {
+            confidence++;
+        }
+    }
+    else
+    {
+        last_stride = stride;
+        confidence = 0;
+    }
+
+    if (confidence >= 1)
+    {
+        issueAlong(block, stride, candidates);
+    }
+}
+
+void Prefetcher::trainStream(size_t block, vector<size_t> &candidates)
+{
+    stream_clock++;
+
+    // A miss shortly ahead of (or behind) a tracked stream belongs to it
+    size_t window = distance + degree;
+    size_t oldest = 0;
+
+    for (size_t s = 0; s < streams.size(); s++)
+    {
+        Stream &stream = streams[s];
+        if (!stream.valid)
+        {
+            oldest = s;
+            continue;
+        }
+
+        if (streams[oldest].valid && stream.last_use < streams[oldest].last_use)
+        {
+            oldest = s;
+        }
+
+        int direction = block > stream.last_block ? 1 : -1;
+        size_t gap = block > stream.last_block ? block - stream.last_block : stream.last_block - block;
+
+        if (gap == 0 || gap > window)
+        {
+            continue;
+        }
+        if (stream.direction != 0 && stream.direction != direction)
+        {
+            continue;
+        }
+
+        stream.direction = direction;
+        stream.last_block = block;
+        stream.last_use = stream_clock;
+        issueAlong(block, direction, candidates);
+        return;
+    }
+
+    // Start a new stream in the free or least recently used slot
+    Stream &stream = streams[oldest];
+    stream.valid = true;
+    stream.last_block = block;
+    stream.direction = 0;
+    stream.last_use = stream_clock;
+}
@@ -0,0 +1,672 @@
+#include "../../include/replacement.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+const uint32_t ReplacementState::NONE;
+const uint8_t ReplacementState::RRPV_MAX;
+const size_t ReplacementState::BRRIP_LONG_INTERVAL;
+const uint32_t ReplacementState::PSEL_MAX;
+
+static const struct
+{
+    ReplacementPolicy policy;
+    const char *name;
+} POLICY_NAMES[] = {
+    {ReplacementPolicy::FIFO, "fifo"},
+    {ReplacementPolicy::LRU, "lru"},
+    {ReplacementPolicy::LFU, "lfu"},
+    {ReplacementPolicy::SRRIP, "srrip"},
+    {ReplacementPolicy::BRRIP, "brrip"},
+    {ReplacementPolicy::DRRIP, "drrip"},
+    {ReplacementPolicy::ARC, "arc"},
+    {ReplacementPolicy::TWO_Q, "2q"},
+};
+
+const char *replacementPolicyName(ReplacementPolicy policy)
+{
+    for (const auto &entry : POLICY_NAMES)
+    {
+        if (entry.policy == policy)
+        {
+            return entry.name;
+        }
+    }
+    return "?";
+}
+
+bool replacementPolicyFromName(const string &name, ReplacementPolicy &policy)
+{
+    for (const auto &entry : POLICY_NAMES)
+    {
+        if (name == entry.name)
+        {
+            policy = entry.policy;
+            return true;
+        }
+    }
+    return false;
+}
+
+ReplacementState::ReplacementState(ReplacementPolicy pol, size_t sets, size_t assoc)
+    : policy(pol), num_sets(sets), associativity(assoc), num_lists(1), psel(PSEL_MAX / 2),
+      num_ghost_lists(0), insert_list(0), incoming_from_b2(false)
+{
+
+    size_t lines = num_sets * associativity;
+
+    next_way.assign(lines, NONE);
+    prev_way.assign(lines, NONE);
+
+    switch (policy)
+    {
+    case ReplacementPolicy::LFU:
+        bucket_freq.assign(lines, 0);
+        bucket_first.assign(lines, NONE);
+        bucket_last.assign(lines, NONE);
+        bucket_next.assign(lines, NONE);
+        bucket_prev.assign(lines, NONE);
+        bucket_head.assign(num_sets, NONE);
+        bucket_free.assign(num_sets, 0);
+        line_bucket.assign(lines, NONE);
+
+        // Every set starts with all of its bucket slots on the free stack
+        for (size_t set = 0; set < num_sets; set++)
+        {
+            size_t base = set * associativity;
+            for (size_t slot = 0; slot + 1 < associativity; slot++)
+            {
+                bucket_next[base + slot] = slot + 1;
+            }
+        }
+        break;
+
+    case ReplacementPolicy::SRRIP:
+    case ReplacementPolicy::BRRIP:
+    case ReplacementPolicy::DRRIP:
+        // RRIP needs no lists: 2 bits of state per line, kept in a byte
+        next_way.clear();
+        prev_way.clear();
+        rrpv.assign(lines, RRPV_MAX);
+        fill_count.assign(num_sets, 0);
+
+        if (policy == ReplacementPolicy::DRRIP)
+        {
+            // Up to 32 leader sets per policy, spread evenly over the level
+            size_t stride = num_sets / max((size_t)1, min((size_t)32, num_sets / 4));
+            dueling_role.assign(num_sets, 2);
+            for (size_t set = 0; set < num_sets; set += stride)
+            {
+                dueling_role[set] = 0;
+                if (set + 1 < num_sets)
+                {
+                    dueling_role[set + 1] = 1;
+                }
+            }
+        }
+        break;
+
+    case ReplacementPolicy::ARC:
+    case ReplacementPolicy::TWO_Q:
+        num_lists = 2;
+        num_ghost_lists = policy == ReplacementPolicy::ARC ? 2 : 1;
+        list_head.assign(num_sets * num_lists, NONE);
+        list_tail.assign(num_sets * num_lists, NONE);
+        list_size.assign(num_sets * num_lists, 0);
+        line_list.assign(lines, 0);
+        ghost_tags.assign(num_sets * num_ghost_lists * associativity, 0);
+        ghost_count.assign(num_sets * num_ghost_lists, 0);
+        if (policy == ReplacementPolicy::ARC)
+        {
+            arc_target.assign(num_sets, 0);
+        }
+        break;
+
+    default:
+        list_head.assign(num_sets, NONE);
+        list_tail.assign(num_sets, NONE);
+        break;
+    }
+}
+
+void ReplacementState::pushFront(size_t set, uint32_t way, uint8_t list)
+{
+    size_t base = set * associativity;
+    size_t index = set * num_lists + list;
+    uint32_t head = list_head[index];
+
+    prev_way[base + way] = NONE;
+    next_way[base + way] = head;
+
+    if (head != NONE)
+        prev_way[base + head] = way;
+    else
+        list_tail[index] = way;
+
+    list_head[index] = way;
+
+    if (!line_list.empty())
+    {
+        line_list[base + way] = list;
+        list_size[index]++;
+    }
+}
+
+void ReplacementState::unlink(size_t set, uint32_t way)
+{
+    size_t base = set * associativity;
+    size_t index = set * num_lists + (line_list.empty() ? 0 : line_list[base + way]);
+    uint32_t prev = prev_way[base + way];
+    uint32_t next = next_way[base + way];
+
+    if (prev != NONE)
+        next_way[base + prev] = next;
+    else
+        list_head[index] = next;
+
+    if (next != NONE)
+        prev_way[base + next] = prev;
+    else
+        list_tail[index] = prev;
+
+    if (!list_size.empty())
+    {
+        list_size[index]--;
+    }
+}
+
+bool ReplacementState::findGhost(size_t set, size_t list, uint64_t tag, size_t &position) const
+{
+    size_t index = set * num_ghost_lists + list;
+    const uint64_t *ghosts = &ghost_tags[index * associativity];
+    const uint64_t *end = ghosts + ghost_count[index];
+
+    const uint64_t *found = find(ghosts, end, tag);
+    position = found - ghosts;
+    return found != end;
+}
+
+void ReplacementState::removeGhost(size_t set, size_t list, size_t position)
+{
+    size_t index = set * num_ghost_lists + list;
+    uint64_t *ghosts = &ghost_tags[index * associativity];
+
+    copy(ghosts + position + 1, ghosts + ghost_count[index], ghosts + position);
+    ghost_count[index]--;
+}
+
+void ReplacementState::trimGhosts(size_t set, size_t list, size_t limit)
+{
+    // Drop the oldest ghosts until at most `limit` are left
+    size_t index = set * num_ghost_lists + list;
+    size_t count = ghost_count[index];
+    if (count <= limit)
+    {
+        return;
+    }
+
+    uint64_t *ghosts = &ghost_tags[index * associativity];
+    copy(ghosts + (count - limit), ghosts + count, ghosts);
+    ghost_count[index] = limit;
+}
+
+void ReplacementState::addGhost(size_t set, size_t list, uint64_t tag, size_t limit)
+{
+    if (limit == 0)
+    {
+        return;
+    }
+
+    size_t index = set * num_ghost_lists + list;
+    trimGhosts(set, list, limit - 1);
+    ghost_tags[index * associativity + ghost_count[index]] = tag;
+    ghost_count[index]++;
+}
+
+void ReplacementState::trainDueling(size_t set)
+{
+    // A miss in a leader set counts against that leader's policy
+    uint8_t role = dueling_role[set];
+    if (role == 0 && psel < PSEL_MAX)
+    {
+        psel++;
+    }
+    else if (role == 1 && psel > 0)
+    {
+        psel--;
+    }
+}
+
+bool ReplacementState::usesBrrip(size_t set) const
+{
+    if (policy != ReplacementPolicy::DRRIP)
+    {
+        return policy == ReplacementPolicy::BRRIP;
+    }
+
+    uint8_t role = dueling_role[set];
+    return role == 2 ? psel > PSEL_MAX / 2 : role == 1;
+}
+
+uint32_t ReplacementState::allocBucket(size_t set, uint64_t freq, uint32_t after)
+{
+    // A set never has more non-empty buckets than ways, so a slot is free
+    size_t base = set * associativity;
+    uint32_t bucket = bucket_free[set];
+    bucket_free[set] = bucket_next[base + bucket];
+
+    bucket_freq[base + bucket] = freq;
+    bucket_first[base + bucket] = NONE;
+    bucket_last[base + bucket] = NONE;
+    bucket_prev[base + bucket] = after;
+
+    if (after == NONE)
+    {
+        bucket_next[base + bucket] = bucket_head[set];
+        bucket_head[set] = bucket;
+    }
+    else
+    {
+        bucket_next[base + bucket] = bucket_next[base + after];
+        bucket_next[base + after] = bucket;
+    }
+
+    uint32_t next = bucket_next[base + bucket];
+    if (next != NONE)
+        bucket_prev[base + next] = bucket;
+
+    return bucket;
+}
+
+void ReplacementState::releaseBucket(size_t set, uint32_t bucket)
+{
+    size_t base = set * associativity;
+    uint32_t prev = bucket_prev[base + bucket];
+    uint32_t next = bucket_next[base + bucket];
+
+    if (prev != NONE)
+        bucket_next[base + prev] = next;
+    else
+        bucket_head[set] = next;
+
+    if (next != NONE)
+        bucket_prev[base + next] = prev;
+
+    bucket_next[base + bucket] = bucket_free[set];
+    bucket_free[set] = bucket;
+}
+
+void ReplacementState::appendToBucket(size_t set, uint32_t bucket, uint32_t way)
+{
+    size_t base = set * associativity;
+    uint32_t last = bucket_last[base + bucket];
+
+    prev_way[base + way] = last;
+    next_way[base + way] = NONE;
+
+    if (last != NONE)
+        next_way[base + last] = way;
+    else
+        bucket_first[base + bucket] = way;
+
+    bucket_last[base + bucket] = way;
+    line_bucket[base + way] = bucket;
+}
+
+void ReplacementState::removeFromBucket(size_t set, uint32_t way)
+{
+    size_t base = set * associativity;
+    uint32_t bucket = line_bucket[base + way];
+    uint32_t prev = prev_way[base + way];
+    uint32_t next = next_way[base + way];
+
+    if (prev != NONE)
+        next_way[base + prev] = next;
+    else
+        bucket_first[base + bucket] = next;
+
+    if (next != NONE)
+        prev_way[base + next] = prev;
+    else
+        bucket_last[base + bucket] = prev;
+
+    line_bucket[base + way] = NONE;
+}
+
+void ReplacementState::onHit(size_t set, size_t way)
+{
+    switch (policy)
+    {
+    case ReplacementPolicy::LRU:
+        unlink(set, way);
+        pushFront(set, way);
+        break;
+
+    case ReplacementPolicy::FIFO:
+        break;
+
+    case ReplacementPolicy::SRRIP:
+    case ReplacementPolicy::BRRIP:
+    case ReplacementPolicy::DRRIP:
+        rrpv[set * associativity + way] = 0;
+        break;
+
+    case ReplacementPolicy::ARC:
+        // Seen again: most recent end of T2
+        if (list_head[set * 2 + 1] != way)
+        {
+            unlink(set, way);
+            pushFront(set, way, 1);
+        }
+        break;
+
+    case ReplacementPolicy::TWO_Q:
+        // Lines on probation (A1in) stay in FIFO order
+        if (line_list[set * associativity + way] == 1)
+        {
+            unlink(set, way);
+            pushFront(set, way, 1);
+        }
+        break;
+
+    case ReplacementPolicy::LFU:
+    {
+        // Move the line to the bucket for freq + 1, creating it if needed
+        size_t base = set * associativity;
+        uint32_t bucket = line_bucket[base + way];
+        uint64_t freq = bucket_freq[base + bucket];
+        uint32_t next = bucket_next[base + bucket];
+
+        if (next != NONE && bucket_freq[base + next] == freq + 1)
+        {
+            removeFromBucket(set, way);
+            appendToBucket(set, next, way);
+
+            if (bucket_first[base + bucket] == NONE)
+            {
+                releaseBucket(set, bucket);
+            }
+        }
+        else if (bucket_first[base + bucket] == bucket_last[base + bucket])
+        {
+            // Sole line in its bucket: the bucket itself moves up
+            bucket_freq[base + bucket]++;
+        }
+        else
+        {
+            uint32_t target = allocBucket(set, freq + 1, bucket);
+            removeFromBucket(set, way);
+            appendToBucket(set, target, way);
+        }
+        break;
+    }
+    }
+}
+
+void ReplacementState::prepareInsert(size_t set, uint64_t tag)
+{
+    size_t position;
+
+    switch (policy)
+    {
+    case ReplacementPolicy::ARC:
+    {
+        uint32_t b1 = ghost_count[set * 2];
+        uint32_t b2 = ghost_count[set * 2 + 1];
+        uint32_t &target = arc_target[set];
+
+        insert_list = 0;
+        incoming_from_b2 = false;
+
+        // A ghost hit means the list it fell out of was too small
+        if (findGhost(set, 0, tag, position))
+        {
+            target = min((uint32_t)associativity, target + max(b2 / b1, 1u));
+            removeGhost(set, 0, position);
+            insert_list = 1;
+        }
+        else if (findGhost(set, 1, tag, position))
+        {
+            uint32_t step = max(b1 / b2, 1u);
+            target = target > step ? target - step : 0;
+            removeGhost(set, 1, position);
+            insert_list = 1;
+            incoming_from_b2 = true;
+        }
+        break;
+    }
+
+    case ReplacementPolicy::TWO_Q:
+        insert_list = 0;
+        if (findGhost(set, 0, tag, position))
+        {
+            removeGhost(set, 0, position);
+            insert_list = 1;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void ReplacementState::onInsert(size_t set, size_t way)
+{
+    size_t base = set * associativity;
+
+    switch (policy)
+    {
+    case ReplacementPolicy::LFU:
+    {
+        uint32_t head = bucket_head[set];
+        uint32_t bucket = head;
+        if (head == NONE || bucket_freq[base + head] != 1)
+        {
+            bucket = allocBucket(set, 1, NONE);
+        }
+        appendToBucket(set, bucket, way);
+        break;
+    }
+
+    case ReplacementPolicy::SRRIP:
+    case ReplacementPolicy::BRRIP:
+    case ReplacementPolicy::DRRIP:
+        rrpv[base + way] = RRPV_MAX - 1;
+        if (usesBrrip(set))
+        {
+            // Bimodal: only every BRRIP_LONG_INTERVAL-th fill is kept longer
+            if (++fill_count[set] < BRRIP_LONG_INTERVAL)
+            {
+                rrpv[base + way] = RRPV_MAX;
+            }
+            else
+            {
+                fill_count[set] = 0;
+            }
+        }
+        break;
+
+    case ReplacementPolicy::ARC:
+    {
+        pushFront(set, way, insert_list);
+
+        // Keep |T1| + |B1| <= c and the whole directory within 2c
+        uint32_t t1 = listSize(set, 0), t2 = listSize(set, 1);
+        trimGhosts(set, 0, associativity - min((size_t)t1, associativity));
+        uint32_t b1 = ghost_count[set * 2];
+        trimGhosts(set, 1, 2 * associativity - min((size_t)(t1 + t2 + b1), 2 * associativity));
+        break;
+    }
+
+    case ReplacementPolicy::TWO_Q:
+        pushFront(set, way, insert_list);
+        break;
+
+    default:
+        pushFront(set, way);
+        break;
+    }
+
+    insert_list = 0;
+    incoming_from_b2 = false;
+}
+
+void ReplacementState::onEvict(size_t set, size_t way, uint64_t tag)
+{
+    size_t base = set * associativity;
+
+    switch (policy)
+    {
+    case ReplacementPolicy::ARC:
+    {
+        // Remember the victim in the ghost list of the list it left
+        uint8_t list = line_list[base + way];
+        unlink(set, way);
+        addGhost(set, list, tag, associativity);
+        break;
+    }
+
+    case ReplacementPolicy::TWO_Q:
+    {
+        uint8_t list = line_list[base + way];
+        unlink(set, way);
+        if (list == 0)
+        {
+            addGhost(set, 0, tag, max((size_t)1, associativity / 2));
+        }
+        break;
+    }
+
+    default:
+        onRemove(set, way);
+        break;
+    }
+}
+
+void ReplacementState::onRemove(size_t set, size_t way)
+{
+    switch (policy)
+    {
+    case ReplacementPolicy::LFU:
+    {
+        size_t base = set * associativity;
+        uint32_t bucket = line_bucket[base + way];
+        removeFromBucket(set, way);
+
+        if (bucket_first[base + bucket] == NONE)
+        {
+            releaseBucket(set, bucket);
+        }
+        break;
+    }
+
+    case ReplacementPolicy::SRRIP:
+    case ReplacementPolicy::BRRIP:
+    case ReplacementPolicy::DRRIP:
+        rrpv[set * associativity + way] = RRPV_MAX;
+        break;
+
+    default:
+        unlink(set, way);
+        break;
+    }
+}
+
+size_t ReplacementState::victim(size_t set)
+{
+    size_t base = set * associativity;
+
+    switch (policy)
+    {
+    case ReplacementPolicy::LFU:
+        return bucket_first[base + bucket_head[set]];
+
+    case ReplacementPolicy::SRRIP:
+    case ReplacementPolicy::BRRIP:
+    case ReplacementPolicy::DRRIP:
+    {
+        // Age the whole set at once until some line is predicted distant,
+        // then take the first such line: the first of the oldest before
+        // ageing. Both loops have no early exit, so they vectorize.
+        uint8_t *values = &rrpv[base];
+        uint8_t oldest = 0;
+        for (size_t way = 0; way < associativity; way++)
+        {
+            oldest = max(oldest, values[way]);
+        }
+
+        size_t chosen = (const uint8_t *)memchr(values, oldest, associativity) - values;
+        uint8_t age = RRPV_MAX - oldest;
+        if (age > 0)
+        {
+            for (size_t way = 0; way < associativity; way++)
+            {
+                values[way] += age;
+            }
+        }
+        return chosen;
+    }
+
+    case ReplacementPolicy::ARC:
+    {
+        // Evict from T1 while it is above its target size
+        uint32_t t1 = listSize(set, 0);
+        uint32_t target = arc_target[set];
+        bool from_t1 = t1 > 0 && (t1 > target || (incoming_from_b2 && t1 == target));
+        if (listSize(set, 1) == 0)
+        {
+            from_t1 = true;
+        }
+        return list_tail[set * 2 + (from_t1 ? 0 : 1)];
+    }
+
+    case ReplacementPolicy::TWO_Q:
+    {
+        size_t probation_size = max((size_t)1, associativity / 4);
+        bool from_probation = listSize(set, 0) > probation_size || listSize(set, 1) == 0;
+        return list_tail[set * 2 + (from_probation ? 0 : 1)];
+    }
+
+    default:
+        return list_tail[set];
+    }
+}
+
+template <typename T>
+static void copyRange(vector<T> &to, const vector<T> &from, size_t first, size_t count)
+{
+    if (!from.empty())
+    {
+        copy(from.begin() + first, from.begin() + first + count, to.begin() + first);
+    }
+}
+
+void ReplacementState::copySet(const ReplacementState &from, size_t set)
+{
+    size_t base = set * associativity;
+
+    copyRange(next_way, from.next_way, base, associativity);
+    copyRange(prev_way, from.prev_way, base, associativity);
+    copyRange(list_head, from.list_head, set * num_lists, num_lists);
+    copyRange(list_tail, from.list_tail, set * num_lists, num_lists);
+    copyRange(list_size, from.list_size, set * num_lists, num_lists);
+    copyRange(line_list, from.line_list, base, associativity);
+
+    copyRange(bucket_freq, from.bucket_freq, base, associativity);
+    copyRange(bucket_first, from.bucket_first, base, associativity);
+    copyRange(bucket_last, from.bucket_last, base, associativity);
+    copyRange(bucket_next, from.bucket_next, base, associativity);
+    copyRange(bucket_prev, from.bucket_prev, base, associativity);
+    copyRange(bucket_head, from.bucket_head, set, 1);
+    copyRange(bucket_free, from.bucket_free, set, 1);
+    copyRange(line_bucket, from.line_bucket, base, associativity);
+
+    copyRange(rrpv, from.rrpv, base, associativity);
+    copyRange(fill_count, from.fill_count, set, 1);
+
+    size_t ghosts = set * num_ghost_lists;
+    copyRange(ghost_tags, from.ghost_tags, ghosts * associativity, num_ghost_lists * associativity);
+    copyRange(ghost_count, from.ghost_count, ghosts, num_ghost_lists);
+    copyRange(arc_target, from.arc_target, set, 1);
+}
@@ -0,0 +1,189 @@
+#include "../../include/sparse_memory.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+const size_t SparseMemory::PAGE_SHIFT;
+const size_t SparseMemory::PAGE_WORDS;
+
+SparseMemory::SparseMemory()
+    : base(nullptr), last_page_number(0), last_page(nullptr)
+{
+}
+
+SparseMemory::SparseMemory(const SparseMemory *base)
+    : base(base), last_page_number(0), last_page(nullptr)
+{
+}
+
+size_t *SparseMemory::findOwnPage(size_t page_number) const
+{
+    if (last_page != nullptr && last_page_number == page_number)
+    {
+        return last_page;
+    }
+
+    auto it = pages.find(page_number);
+    if (it == pages.end())
+    {
+        return nullptr;
+    }
+
+    last_page_number = page_number;
+    last_page = it->second.get();
+    return last_page;
+}
+
+const size_t *SparseMemory::findPage(size_t page_number) const
+{
+    const size_t *page = findOwnPage(page_number);
+    if (page != nullptr || base == nullptr)
+    {
+        return page;
+    }
+
+    // Bypass the base's lookup cache: other shards read it concurrently
+    auto it = base->pages.find(page_number);
+    return it != base->pages.end() ? it->second.get() : nullptr;
+}
+
+size_t *SparseMemory::touchPage(size_t page_number)
+{
+    size_t *page = findOwnPage(page_number);
+    if (page != nullptr)
+    {
+        return page;
+    }
+
+    // First write to this page: allocate it zero-filled, or as a copy of
+    // the base's page in a shard
+    const size_t *original = findPage(page_number);
+    unique_ptr<size_t[]> &slot = pages[page_number];
+    slot.reset(new size_t[PAGE_WORDS]());
+    if (original != nullptr)
+    {
+        memcpy(slot.get(), original, PAGE_WORDS * sizeof(size_t));
+    }
+
+    last_page_number = page_number;
+    last_page = slot.get();
+    return last_page;
+}
+
+void SparseMemory::mergeShards(const vector<const SparseMemory *> &shards)
+{
+    vector<size_t> original(PAGE_WORDS);
+
+    for (size_t s = 0; s < shards.size(); s++)
+    {
+        for (const auto &entry : shards[s]->pages)
+        {
+            // Every shard copy of a page is handled when it is first seen
+            bool seen = false;
+            for (size_t earlier = 0; earlier < s && !seen; earlier++)
+            {
+                seen = shards[earlier]->pages.count(entry.first) > 0;
+            }
+            if (seen)
+            {
+                continue;
+            }
+
+            const size_t *page = findOwnPage(entry.first);
+            if (page != nullptr)
+            {
+                memcpy(original.data(), page, PAGE_WORDS * sizeof(size_t));
+            }
+            else
+            {
+                fill(original.begin(), original.end(), 0);
+            }
+
+            size_t *merged = touchPage(entry.first);
+            for (size_t t = s; t < shards.size(); t++)
+            {
+                const size_t *copy = shards[t]->findOwnPage(entry.first);
+                if (copy == nullptr)
+                {
+                    continue;
+                }
+                for (size_t w = 0; w < PAGE_WORDS; w++)
+                {
+                    if (copy[w] != original[w])
+                    {
+                        merged[w] = copy[w];
+                    }
+                }
+            }
+        }
+    }
+}
+
+size_t SparseMemory::read(size_t address) const
+{
+    const size_t *page = findPage(address >> PAGE_SHIFT);
+    return page != nullptr ? page[address & (PAGE_WORDS - 1)] : 0;
+}
+
+void SparseMemory::write(size_t address, size_t value)
+{
+    size_t page_number = address >> PAGE_SHIFT;
+
+    // Writing zero to an untouched page changes nothing
+    if (value == 0 && findPage(page_number) == nullptr)
+    {
+        return;
+    }
+
+    touchPage(page_number)[address & (PAGE_WORDS - 1)] = value;
+}
+
+void SparseMemory::readBlock(size_t address, size_t *words, size_t count) const
+{
+    // Copy page by page, so a block straddling two pages still works
+    while (count > 0)
+    {
+        size_t offset = address & (PAGE_WORDS - 1);
+        size_t chunk = min(count, PAGE_WORDS - offset);
+        const size_t *page = findPage(address >> PAGE_SHIFT);
+
+        if (page != nullptr)
+        {
+            memcpy(words, page + offset, chunk * sizeof(size_t));
+        }
+        else
+        {
+            memset(words, 0, chunk * sizeof(size_t));
+        }
+
+        address += chunk;
+        words += chunk;
+        count -= chunk;
+    }
+}
+
+void SparseMemory::writeBlock(size_t address, const size_t *words, size_t count)
+{
+    while (count > 0)
+    {
+        size_t offset = address & (PAGE_WORDS - 1);
+        size_t chunk = min(count, PAGE_WORDS - offset);
+        size_t page_number = address >> PAGE_SHIFT;
+
+        bool all_zero = true;
+        for (size_t i = 0; i < chunk && all_zero; i++)
+        {
+            all_zero = words[i] == 0;
+        }
+
+        if (!all_zero || findPage(page_number) != nullptr)
+        {
+            memcpy(touchPage(page_number) + offset, words, chunk * sizeof(size_t));
+        }
+
+        address += chunk;
+        words += chunk;
+        count -= chunk;
+    }
+}
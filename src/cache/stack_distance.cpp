@@ -0,0 +1,116 @@
+#include "../../include/stack_distance.h"
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+size_t StackDistanceAnalyzer::ReuseCounter::tick()
+{
+    time++;
+
+    size_t capacity = tree.size() - 1;
+    if (time > capacity)
+    {
+        // Nodes up to the old capacity keep their ranges; the new root
+        // covers every mark placed so far
+        tree.resize(2 * capacity + 1, 0);
+        tree[2 * capacity] = live;
+    }
+    return time;
+}
+
+void StackDistanceAnalyzer::ReuseCounter::add(size_t index, int64_t delta)
+{
+    for (size_t i = index; i < tree.size(); i += i & (~i + 1))
+    {
+        tree[i] += delta;
+    }
+}
+
+uint64_t StackDistanceAnalyzer::ReuseCounter::prefix(size_t index) const
+{
+    uint64_t sum = 0;
+    for (size_t i = index; i > 0; i -= i & (~i + 1))
+    {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+StackDistanceAnalyzer::StackDistanceAnalyzer(size_t block_size, size_t num_sets)
+    : block_size(block_size), num_sets(num_sets), sets(num_sets),
+      accesses(0), cold_misses(0)
+{
+}
+
+void StackDistanceAnalyzer::access(size_t address)
+{
+    size_t block = address / block_size;
+    ReuseCounter &set = sets[block % num_sets];
+    size_t now = set.tick();
+    accesses++;
+
+    auto it = last_access.find(block);
+    if (it == last_access.end())
+    {
+        cold_misses++;
+        last_access[block] = now;
+        set.live++;
+        set.add(now, 1);
+        return;
+    }
+
+    uint64_t distance = set.live - set.prefix(it->second);
+    if (distance >= distances.size())
+    {
+        distances.resize(distance + 1, 0);
+    }
+    distances[distance]++;
+
+    set.add(it->second, -1);
+    set.add(now, 1);
+    it->second = now;
+}
+
+uint64_t StackDistanceAnalyzer::getMisses(size_t ways) const
+{
+    uint64_t misses = cold_misses;
+    for (size_t d = ways; d < distances.size(); d++)
+    {
+        misses += distances[d];
+    }
+    return misses;
+}
+
+double StackDistanceAnalyzer::getMissRatio(size_t ways) const
+{
+    return accesses > 0 ? (double)getMisses(ways) / accesses * 100 : 0.0;
+}
+
+void StackDistanceAnalyzer::printCurve() const
+{
+    cout << "  " << setw(8) << (num_sets == 1 ? "Blocks" : "Ways") << setw(12) << "Size"
+         << setw(12) << "Misses" << setw(12) << "Miss Ratio" << endl;
+
+    // With `ways` ways, accesses at distance >= ways miss
+    size_t last = distances.empty() ? 1 : distances.size();
+    uint64_t misses = getMisses(1);
+    size_t counted = 1;
+
+    for (size_t ways = 1;; ways = ways * 2 < last ? ways * 2 : last)
+    {
+        for (; counted < ways; counted++)
+        {
+            misses -= distances[counted];
+        }
+
+        double ratio = accesses > 0 ? (double)misses / accesses * 100 : 0.0;
+        cout << "  " << setw(8) << ways << setw(12) << ways * num_sets * block_size
+             << setw(12) << misses << setw(11) << fixed << setprecision(2) << ratio << "%" << endl;
+
+        if (ways == last)
+        {
+            break;
+        }
+    }
+}
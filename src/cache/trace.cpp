@@ -0,0 +1,164 @@
+#include "../../include/trace.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+static bool parseNumber(const string &token, size_t &value)
+{
+    if (token.empty() || token[0] == '-')
+    {
+        return false;
+    }
+
+    try
+    {
+        size_t used;
+        value = stoull(token, &used, 0);
+        return used == token.size();
+    }
+    catch (const exception &)
+    {
+        return false;
+    }
+}
+
+// Parses "R <address>", "W <address> [data]" or a bare address, where
+// `first` is the line's first token and the rest is still in `iss`
+static bool parseAccess(const string &first, istringstream &iss, size_t line_number, TraceAccess &access)
+{
+    access.is_write = false;
+    access.data = line_number;
+
+    string address_token = first;
+    if (first == "R" || first == "r" || first == "W" || first == "w")
+    {
+        access.is_write = (first == "W" || first == "w");
+        if (!(iss >> address_token))
+        {
+            address_token.clear();
+        }
+    }
+
+    bool valid = parseNumber(address_token, access.address);
+
+    string extra;
+    if (valid && iss >> extra)
+    {
+        valid = access.is_write && parseNumber(extra, access.data) && !(iss >> extra);
+    }
+    return valid;
+}
+
+bool loadTrace(const string &path, vector<TraceAccess> &trace)
+{
+    ifstream file(path);
+    if (!file)
+    {
+        cerr << "Error: Cannot open trace file " << path << endl;
+        return false;
+    }
+
+    trace.clear();
+
+    string line;
+    size_t line_number = 0;
+    while (getline(file, line))
+    {
+        line_number++;
+
+        istringstream iss(line);
+        string first;
+        if (!(iss >> first) || first[0] == '#')
+        {
+            continue;
+        }
+
+        TraceAccess access;
+        if (!parseAccess(first, iss, line_number, access))
+        {
+            cerr << "Error: " << path << ":" << line_number << ": malformed trace line" << endl;
+            return false;
+        }
+
+        trace.push_back(access);
+    }
+
+    return true;
+}
+
+// Traces whose lines start with a number before the access (a core or a
+// timestamp); `add` takes the number and the access
+template <typename Add>
+static bool loadPrefixedTrace(const string &path, Add add)
+{
+    ifstream file(path);
+    if (!file)
+    {
+        cerr << "Error: Cannot open trace file " << path << endl;
+        return false;
+    }
+
+    string line;
+    size_t line_number = 0;
+    while (getline(file, line))
+    {
+        line_number++;
+
+        istringstream iss(line);
+        string prefix_token;
+        if (!(iss >> prefix_token) || prefix_token[0] == '#')
+        {
+            continue;
+        }
+
+        size_t prefix;
+        TraceAccess access;
+        string first;
+        if (!parseNumber(prefix_token, prefix) || !(iss >> first) ||
+            !parseAccess(first, iss, line_number, access))
+        {
+            cerr << "Error: " << path << ":" << line_number << ": malformed trace line" << endl;
+            return false;
+        }
+
+        add(prefix, access);
+    }
+
+    return true;
+}
+
+bool loadCoreTrace(const string &path, vector<CoreAccess> &trace)
+{
+    trace.clear();
+    auto add = [&](size_t core, const TraceAccess &access)
+    {
+        CoreAccess tagged = {core, access};
+        trace.push_back(tagged);
+    };
+    return loadPrefixedTrace(path, add);
+}
+
+bool loadTimedTrace(const string &path, vector<TimedAccess> &trace)
+{
+    trace.clear();
+    bool ordered = true;
+    auto add = [&](size_t time, const TraceAccess &access)
+    {
+        ordered = ordered && (trace.empty() || time >= trace.back().time);
+        TimedAccess timed = {time, access};
+        trace.push_back(timed);
+    };
+
+    if (!loadPrefixedTrace(path, add))
+    {
+        return false;
+    }
+    if (!ordered)
+    {
+        cerr << "Error: " << path << ": timestamps must not decrease" << endl;
+        return false;
+    }
+    return true;
+}
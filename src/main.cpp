@@ -2,11 +2,20 @@
 #include "../include/buddy_allocator.h"
 #include "../include/cache.h"
 #include "../include/virtual_memory.h"
+#include "../include/stack_distance.h"
+#include "../include/trace.h"
+#include "../include/cache_sweep.h"
+#include "../include/coherence.h"
+#include "../include/colocation.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <algorithm>
+#include <iomanip>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
 #include <unistd.h>
 #include <sys/stat.h>
 
@@ -19,9 +28,15 @@ private:
     BuddyAllocator *buddy_allocator;
     CacheHierarchy *cache_hierarchy;
     VirtualMemory *virtual_memory;
+    CacheSweep *cache_sweep;
+    MultiCoreHierarchy *multicore;
+    Colocation *colocation;
 
     bool memory_initialized;
     bool cache_initialized;
+
+    // Cycles of every integrated access: translation plus cache hierarchy
+    LatencyStats integrated_latency;
     bool vm_initialized;
     bool using_buddy;
 
@@ -31,6 +46,7 @@ private:
         cout << "\nMemory Allocation Commands:" << endl;
         cout << "  init memory <size>              - Initialize physical memory" << endl;
         cout << "  set allocator <type>            - Set allocator (first_fit/best_fit/worst_fit/buddy)" << endl;
+        cout << "  set allocator buddy <min_block> - Buddy allocator with a custom minimum block size" << endl;
         cout << "  malloc <size>                   - Allocate memory block" << endl;
         cout << "  free <block_id>                 - Free memory block" << endl;
         cout << "  dump memory                     - Show memory layout" << endl;
@@ -38,11 +54,56 @@ private:
 
         cout << "\nCache Commands:" << endl;
         cout << "  init cache <mem_size>           - Initialize cache hierarchy and memory" << endl;
-        cout << "  add cache <size> <block> <assoc> <policy>" << endl;
-        cout << "                                  - Add cache level (policy: fifo/lru/lfu)" << endl;
+        cout << "  add cache <size> <block> <assoc> <policy> [wt|wb] [nwa|wa]" << endl;
+        cout << "                                  - Add cache level (policy: fifo/lru/lfu/srrip/" << endl;
+        cout << "                                    brrip/drrip/arc/2q, default write-through," << endl;
+        cout << "                                    no-write-allocate)" << endl;
+        cout << "  add prefetcher <level> <type> [degree] [distance] [latency]" << endl;
+        cout << "                                  - Attach a prefetcher (nextline/stride/stream)" << endl;
+        cout << "  add victim <level> <entries>    - Attach a fully associative victim cache" << endl;
+        cout << "  add misscache <level> <entries> - Attach a fully associative miss cache" << endl;
+        cout << "  set latency <target> <cycles>   - Set l1/l2/.../memory/fault latency in cycles" << endl;
+        cout << "  set inclusion <policy>          - Set inclusion policy (nine/inclusive/exclusive)" << endl;
+        cout << "  set classify <on|off>           - Split misses into compulsory/capacity/conflict" << endl;
+        cout << "  set mshrs <level> <entries>     - Make a level non-blocking (0 = blocking)" << endl;
         cout << "  cache read <address>            - Read from address through cache" << endl;
         cout << "  cache write <address> <data>    - Write to address through cache" << endl;
+        cout << "  cache trace <file> [threads]    - Replay a memory trace through the cache" << endl;
+        cout << "                                    (threads > 1: sets split between threads)" << endl;
         cout << "  cache stats                     - Show cache statistics" << endl;
+        cout << "  analyze <trace> <block> [sets...]" << endl;
+        cout << "                                  - LRU miss ratio of every size in one pass" << endl;
+        cout << "                                    (fully associative, plus each set count)" << endl;
+
+        cout << "\nCache Sweep Commands:" << endl;
+        cout << "  sweep init <mem_size>           - Start a new set of configurations" << endl;
+        cout << "  sweep add <size> <block> <assoc> <policy> [wt|wb] [nwa|wa] [/ ...]" << endl;
+        cout << "                                  - Add a configuration ('/' separates levels)" << endl;
+        cout << "  sweep grid <sizes> <blocks> <assocs> <policies> [wt|wb] [nwa|wa]" << endl;
+        cout << "                                  - Add every combination of comma-separated lists" << endl;
+        cout << "  sweep run <trace> [threads]     - Simulate all configurations in parallel" << endl;
+
+        cout << "\nMulti-core Commands:" << endl;
+        cout << "  init multicore <cores> <mem_size> - Initialize cores sharing coherent caches" << endl;
+        cout << "  add private <size> <block> <assoc> <policy>" << endl;
+        cout << "                                  - Add a private level to every core" << endl;
+        cout << "  add shared <size> <block> <assoc> <policy>" << endl;
+        cout << "                                  - Set the shared last-level cache" << endl;
+        cout << "  set protocol <mesi|moesi>       - Set the coherence protocol (default mesi)" << endl;
+        cout << "  multicore read <core> <address> - Read from address on a core" << endl;
+        cout << "  multicore write <core> <address> <data> - Write to address on a core" << endl;
+        cout << "  multicore trace <file>          - Replay a trace of '<core> R|W <address>' lines" << endl;
+        cout << "  multicore stats                 - Show per-core and coherence statistics" << endl;
+        cout << "  multicore hotspots [count]      - Blocks with the most coherence traffic" << endl;
+
+        cout << "\nCo-location Commands:" << endl;
+        cout << "  colocate init <virt_bits> <phys_bits> <page_size> <policy>" << endl;
+        cout << "                                  - Start a co-location study (shared frames)" << endl;
+        cout << "  colocate cache <size> <block> <assoc> <policy> [wt|wb] [nwa|wa]" << endl;
+        cout << "                                  - Add a cache level (the last one is shared)" << endl;
+        cout << "  colocate thread <trace> [weight] - Add a thread replaying its own trace" << endl;
+        cout << "  colocate run <mode> [workers]   - Interleave the threads (roundrobin/weighted/" << endl;
+        cout << "                                    timestamp) and report hit ratios and interference" << endl;
 
         cout << "\nVirtual Memory Commands:" << endl;
         cout << "  init vm <virt_bits> <phys_bits> <page_size> <policy>" << endl;
@@ -86,6 +147,187 @@ private:
         cout << "Memory initialized: " << size << " bytes" << endl;
     }
 
+    void handleSetInclusion(istringstream &iss)
+    {
+        string type;
+        if (!(iss >> type))
+        {
+            cerr << "Usage: set inclusion <nine|inclusive|exclusive>" << endl;
+            return;
+        }
+
+        if (!cache_initialized)
+        {
+            cerr << "Error: Initialize cache first" << endl;
+            return;
+        }
+
+        transform(type.begin(), type.end(), type.begin(), ::tolower);
+
+        InclusionPolicy policy;
+        if (type == "nine")
+        {
+            policy = InclusionPolicy::NINE;
+        }
+        else if (type == "inclusive")
+        {
+            policy = InclusionPolicy::INCLUSIVE;
+        }
+        else if (type == "exclusive")
+        {
+            policy = InclusionPolicy::EXCLUSIVE;
+        }
+        else
+        {
+            cerr << "Unknown inclusion policy: " << type << " (options: nine, inclusive, exclusive)" << endl;
+            return;
+        }
+
+        if (cache_hierarchy->setInclusionPolicy(policy))
+        {
+            cout << "Inclusion policy set to: " << type << endl;
+        }
+    }
+
+    void handleSetClassify(istringstream &iss)
+    {
+        string mode;
+        if (!(iss >> mode))
+        {
+            cerr << "Usage: set classify <on|off>" << endl;
+            return;
+        }
+
+        if (!cache_initialized)
+        {
+            cerr << "Error: Initialize cache first" << endl;
+            return;
+        }
+
+        transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+
+        if (mode != "on" && mode != "off")
+        {
+            cerr << "Unknown classify mode: " << mode << " (options: on, off)" << endl;
+            return;
+        }
+
+        cache_hierarchy->setMissClassification(mode == "on");
+        cout << "Miss classification " << (mode == "on" ? "enabled" : "disabled") << endl;
+    }
+
+    void handleSetMSHRs(istringstream &iss)
+    {
+        size_t level, entries;
+        if (!(iss >> level >> entries))
+        {
+            cerr << "Usage: set mshrs <level> <entries>" << endl;
+            return;
+        }
+
+        if (!cache_initialized)
+        {
+            cerr << "Error: Initialize cache first" << endl;
+            return;
+        }
+
+        if (level == 0)
+        {
+            cerr << "Error: Cache levels are numbered from L1" << endl;
+            return;
+        }
+
+        if (cache_hierarchy->setMSHRs(level - 1, entries))
+        {
+            if (entries == 0)
+            {
+                cout << "L" << level << " set to blocking (no MSHRs)" << endl;
+            }
+            else
+            {
+                cout << "L" << level << " set to non-blocking with " << entries << " MSHRs" << endl;
+            }
+        }
+    }
+
+    void handleSetLatency(istringstream &iss)
+    {
+        string target;
+        uint64_t cycles;
+        if (!(iss >> target >> cycles))
+        {
+            cerr << "Usage: set latency <l1|l2|...|memory|fault> <cycles>" << endl;
+            return;
+        }
+
+        transform(target.begin(), target.end(), target.begin(), ::tolower);
+
+        if (target == "fault")
+        {
+            if (!vm_initialized)
+            {
+                cerr << "Error: Initialize VM first" << endl;
+                return;
+            }
+            virtual_memory->setFaultLatency(cycles);
+            cout << "Page fault service time set to " << cycles << " cycles" << endl;
+            return;
+        }
+
+        // Cache latencies apply to the cache hierarchy and the multi-core
+        // hierarchy alike, whichever are initialized
+        if (!cache_initialized && !multicore)
+        {
+            cerr << "Error: Initialize cache or multicore first" << endl;
+            return;
+        }
+
+        if (target == "memory")
+        {
+            if (cache_initialized)
+            {
+                cache_hierarchy->setMemoryLatency(cycles);
+            }
+            if (multicore)
+            {
+                multicore->setMemoryLatency(cycles);
+            }
+            cout << "Memory latency set to " << cycles << " cycles" << endl;
+        }
+        else if (target.size() > 1 && target[0] == 'l' &&
+                 target.find_first_not_of("0123456789", 1) == string::npos)
+        {
+            size_t level = stoul(target.substr(1));
+            if (level == 0)
+            {
+                cerr << "Error: Cache levels are numbered from L1" << endl;
+                return;
+            }
+
+            bool found = false;
+            if (cache_initialized && level <= cache_hierarchy->getNumLevels())
+            {
+                cache_hierarchy->setHitLatency(level - 1, cycles);
+                cout << "L" << level << " hit latency set to " << cycles << " cycles" << endl;
+                found = true;
+            }
+            if (multicore && level <= multicore->getNumLevels())
+            {
+                multicore->setHitLatency(level - 1, cycles);
+                cout << "Multi-core L" << level << " hit latency set to " << cycles << " cycles" << endl;
+                found = true;
+            }
+            if (!found)
+            {
+                cerr << "Error: Cache level L" << level << " does not exist" << endl;
+            }
+        }
+        else
+        {
+            cerr << "Unknown latency target: " << target << " (options: l1, l2, ..., memory, fault)" << endl;
+        }
+    }
+
     void handleSetAllocator(istringstream &iss)
     {
         string type;
@@ -105,13 +347,27 @@ private:
                 return;
             }
 
+            // Optional minimum block size, e.g. 4096 for page-sized blocks
+            size_t min_block;
+            if (!(iss >> min_block))
+            {
+                min_block = 64;
+            }
+
             size_t total_mem = allocator->getTotalMemory();
+            if (min_block == 0 || min_block > total_mem)
+            {
+                cerr << "Error: Minimum block size must be between 1 and " << total_mem << " bytes" << endl;
+                return;
+            }
+
             delete allocator;
             allocator = nullptr;
 
-            buddy_allocator = new BuddyAllocator(total_mem);
+            buddy_allocator = new BuddyAllocator(total_mem, min_block);
             using_buddy = true;
-            cout << "Switched to buddy allocator" << endl;
+            cout << "Switched to buddy allocator (minimum block "
+                 << buddy_allocator->getMinBlockSize() << " bytes)" << endl;
         }
         else
         {
@@ -152,202 +408,1059 @@ private:
                 cerr << "Options: first_fit, best_fit, worst_fit, buddy" << endl;
             }
         }
-    }
+    }
+
+    void handleMalloc(istringstream &iss)
+    {
+        size_t size;
+        if (!(iss >> size))
+        {
+            cerr << "Usage: malloc <size>" << endl;
+            return;
+        }
+
+        if (!memory_initialized)
+        {
+            cerr << "Error: Initialize memory first" << endl;
+            return;
+        }
+
+        if (using_buddy)
+        {
+            buddy_allocator->malloc(size);
+        }
+        else
+        {
+            allocator->malloc(size);
+        }
+    }
+
+    void handleFree(istringstream &iss)
+    {
+        int block_id;
+        if (!(iss >> block_id))
+        {
+            cerr << "Usage: free <block_id>" << endl;
+            return;
+        }
+
+        if (!memory_initialized)
+        {
+            cerr << "Error: Initialize memory first" << endl;
+            return;
+        }
+
+        if (using_buddy)
+        {
+            buddy_allocator->free(block_id);
+        }
+        else
+        {
+            allocator->free(block_id);
+        }
+    }
+
+    void handleDumpMemory()
+    {
+        if (!memory_initialized)
+        {
+            cerr << "Error: Initialize memory first" << endl;
+            return;
+        }
+
+        if (using_buddy)
+        {
+            buddy_allocator->dumpMemory();
+        }
+        else
+        {
+            allocator->dumpMemory();
+        }
+    }
+
+    void handleStats()
+    {
+        if (!memory_initialized)
+        {
+            cerr << "Error: Initialize memory first" << endl;
+            return;
+        }
+
+        if (using_buddy)
+        {
+            buddy_allocator->printStats();
+        }
+        else
+        {
+            allocator->printStats();
+        }
+    }
+
+    void handleInitCache(istringstream &iss)
+    {
+        size_t mem_size;
+        if (!(iss >> mem_size))
+        {
+            cerr << "Usage: init cache <memory_size>" << endl;
+            return;
+        }
+
+        if (cache_hierarchy)
+            delete cache_hierarchy;
+
+        cache_hierarchy = new CacheHierarchy(mem_size);
+        cache_initialized = true;
+
+        cout << "Cache hierarchy initialized with " << mem_size << " bytes of memory" << endl;
+    }
+
+    bool parseReplacementPolicy(const string &name, ReplacementPolicy &policy)
+    {
+        if (!replacementPolicyFromName(name, policy))
+        {
+            cerr << "Unknown policy: " << name << endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Optional write policies: wt/wb and nwa/wa (default wt nwa)
+    bool parseWriteOptions(istringstream &iss, WritePolicy &write_policy, WriteMissPolicy &miss_policy)
+    {
+        write_policy = WritePolicy::WRITE_THROUGH;
+        miss_policy = WriteMissPolicy::NO_WRITE_ALLOCATE;
+
+        string option;
+        while (iss >> option)
+        {
+            transform(option.begin(), option.end(), option.begin(), ::tolower);
+
+            if (option == "wt")
+            {
+                write_policy = WritePolicy::WRITE_THROUGH;
+            }
+            else if (option == "wb")
+            {
+                write_policy = WritePolicy::WRITE_BACK;
+            }
+            else if (option == "nwa")
+            {
+                miss_policy = WriteMissPolicy::NO_WRITE_ALLOCATE;
+            }
+            else if (option == "wa")
+            {
+                miss_policy = WriteMissPolicy::WRITE_ALLOCATE;
+            }
+            else
+            {
+                cerr << "Unknown write policy: " << option << " (options: wt, wb, wa, nwa)" << endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void handleAddCache(istringstream &iss)
+    {
+        size_t size, block_size, assoc;
+        string policy_str;
+
+        if (!(iss >> size >> block_size >> assoc >> policy_str))
+        {
+            cerr << "Usage: add cache <size> <block_size> <associativity> <policy>" << endl;
+            return;
+        }
+
+        if (!cache_initialized)
+        {
+            cerr << "Error: Initialize cache first" << endl;
+            return;
+        }
+
+        transform(policy_str.begin(), policy_str.end(), policy_str.begin(), ::tolower);
+
+        ReplacementPolicy policy = ReplacementPolicy::LRU;
+        if (!parseReplacementPolicy(policy_str, policy))
+        {
+            return;
+        }
+
+        WritePolicy write_policy;
+        WriteMissPolicy miss_policy;
+        if (!parseWriteOptions(iss, write_policy, miss_policy))
+        {
+            return;
+        }
+
+        if (!cache_hierarchy->addLevel(size, block_size, assoc, policy, write_policy, miss_policy))
+        {
+            return;
+        }
+        cout << "Added cache level: " << size << " bytes, " << block_size
+             << " block size, " << assoc << "-way, " << policy_str;
+        if (write_policy == WritePolicy::WRITE_BACK || miss_policy == WriteMissPolicy::WRITE_ALLOCATE)
+        {
+            cout << ", " << (write_policy == WritePolicy::WRITE_BACK ? "write-back" : "write-through")
+                 << ", " << (miss_policy == WriteMissPolicy::WRITE_ALLOCATE ? "write-allocate" : "no-write-allocate");
+        }
+        cout << endl;
+    }
+
+    void handleAddPrefetcher(istringstream &iss)
+    {
+        size_t level;
+        string type_str;
+
+        if (!(iss >> level >> type_str))
+        {
+            cerr << "Usage: add prefetcher <level> <type> [degree] [distance] [latency]" << endl;
+            return;
+        }
+
+        if (!cache_initialized)
+        {
+            cerr << "Error: Initialize cache first" << endl;
+            return;
+        }
+
+        transform(type_str.begin(), type_str.end(), type_str.begin(), ::tolower);
+
+        PrefetcherType type;
+        if (type_str == "nextline")
+        {
+            type = PrefetcherType::NEXT_LINE;
+        }
+        else if (type_str == "stride")
+        {
+            type = PrefetcherType::STRIDE;
+        }
+        else if (type_str == "stream")
+        {
+            type = PrefetcherType::STREAM;
+        }
+        else
+        {
+            cerr << "Unknown prefetcher: " << type_str << " (options: nextline, stride, stream)" << endl;
+            return;
+        }
+
+        // Optional degree, distance (in blocks) and latency (in cycles)
+        size_t degree = 1, distance = 1, latency = 4;
+        iss >> degree >> distance >> latency;
+
+        if (level == 0 || degree == 0 || distance == 0)
+        {
+            cerr << "Error: Level, degree and distance must be at least 1" << endl;
+            return;
+        }
+
+        if (cache_hierarchy->setPrefetcher(level - 1, type, degree, distance, latency))
+        {
+            cout << "Added " << type_str << " prefetcher to L" << level << ": degree " << degree
+                 << ", distance " << distance << ", latency " << latency << " cycles" << endl;
+        }
+    }
+
+    void handleAddSideCache(istringstream &iss, SideCacheType type)
+    {
+        const char *name = type == SideCacheType::VICTIM ? "victim" : "misscache";
+        size_t level, entries;
+
+        if (!(iss >> level >> entries))
+        {
+            cerr << "Usage: add " << name << " <level> <entries>" << endl;
+            return;
+        }
+
+        if (!cache_initialized)
+        {
+            cerr << "Error: Initialize cache first" << endl;
+            return;
+        }
+
+        if (level == 0 || entries == 0)
+        {
+            cerr << "Error: Level and entries must be at least 1" << endl;
+            return;
+        }
+
+        if (cache_hierarchy->setSideCache(level - 1, type, entries))
+        {
+            cout << "Added " << entries << "-entry "
+                 << (type == SideCacheType::VICTIM ? "victim cache" : "miss cache")
+                 << " to L" << level << endl;
+        }
+    }
+
+    void handleCacheRead(istringstream &iss)
+    {
+        size_t address;
+        if (!(iss >> address))
+        {
+            cerr << "Usage: cache read <address>" << endl;
+            return;
+        }
+
+        if (!cache_initialized)
+        {
+            cerr << "Error: Initialize cache first" << endl;
+            return;
+        }
+
+        size_t data = cache_hierarchy->read(address);
+        cout << "Read address " << address << ": data = " << data << endl;
+    }
+
+    void handleCacheWrite(istringstream &iss)
+    {
+        size_t address, data;
+        if (!(iss >> address >> data))
+        {
+            cerr << "Usage: cache write <address> <data>" << endl;
+            return;
+        }
+
+        if (!cache_initialized)
+        {
+            cerr << "Error: Initialize cache first" << endl;
+            return;
+        }
+
+        cache_hierarchy->write(address, data);
+        cout << "Wrote " << data << " to address " << address << endl;
+    }
+
+    // Reads an optional whole number: `value` keeps its default when no
+    // token is left, and a token that is not one (a sign, letters, too
+    // large) is reported and rejected
+    bool readOptionalCount(istringstream &iss, const char *what, size_t &value)
+    {
+        string token;
+        if (!(iss >> token))
+        {
+            return true;
+        }
+
+        errno = 0;
+        char *end = nullptr;
+        unsigned long long parsed = strtoull(token.c_str(), &end, 10);
+        if (token.find_first_not_of("0123456789") != string::npos || *end != '\0' ||
+            errno == ERANGE || parsed > SIZE_MAX)
+        {
+            cerr << "Error: Invalid " << what << ": " << token << endl;
+            return false;
+        }
+        value = (size_t)parsed;
+        return true;
+    }
+
+    void handleCacheTrace(istringstream &iss)
+    {
+        string path;
+        if (!(iss >> path))
+        {
+            cerr << "Usage: cache trace <file> [threads]" << endl;
+            return;
+        }
+
+        size_t threads = 1;
+        if (!readOptionalCount(iss, "thread count", threads))
+        {
+            return;
+        }
+        if (threads == 0)
+        {
+            cerr << "Error: Thread count must be at least 1" << endl;
+            return;
+        }
+
+        if (!cache_initialized)
+        {
+            cerr << "Error: Initialize cache first" << endl;
+            return;
+        }
+
+        vector<TraceAccess> trace;
+        if (!loadTrace(path, trace))
+        {
+            return;
+        }
+
+        size_t partitions = cache_hierarchy->replay(trace, threads);
+        if (partitions == 0)
+        {
+            return;
+        }
+
+        size_t writes = 0;
+        for (const TraceAccess &access : trace)
+        {
+            writes += access.is_write ? 1 : 0;
+        }
+
+        cout << "Replayed " << trace.size() << " accesses from " << path << " ("
+             << trace.size() - writes << " reads, " << writes << " writes)";
+        if (threads > 1)
+        {
+            cout << " on " << partitions << (partitions == 1 ? " set partition" : " set partitions");
+        }
+        cout << endl;
+    }
+
+    void handleAnalyze(istringstream &iss)
+    {
+        string path;
+        size_t block_size;
+        if (!(iss >> path >> block_size) || block_size == 0)
+        {
+            cerr << "Usage: analyze <trace_file> <block_size> [num_sets ...]" << endl;
+            return;
+        }
+
+        vector<size_t> set_counts(1, 1);
+        size_t num_sets;
+        while (iss >> num_sets)
+        {
+            if (num_sets == 0)
+            {
+                cerr << "Error: Number of sets must be positive" << endl;
+                return;
+            }
+            set_counts.push_back(num_sets);
+        }
+
+        vector<TraceAccess> trace;
+        if (!loadTrace(path, trace))
+        {
+            return;
+        }
+
+        vector<StackDistanceAnalyzer> analyzers;
+        for (size_t sets : set_counts)
+        {
+            analyzers.push_back(StackDistanceAnalyzer(block_size, sets));
+        }
+
+        // A single pass over the trace feeds every geometry
+        for (const TraceAccess &access : trace)
+        {
+            for (StackDistanceAnalyzer &analyzer : analyzers)
+            {
+                analyzer.access(access.address);
+            }
+        }
+
+        cout << "\n=== Stack Distance Analysis ===" << endl;
+        cout << "Trace: " << path << " (" << trace.size() << " accesses, "
+             << block_size << "-byte blocks)" << endl;
+        cout << "Cold misses: " << analyzers[0].getColdMisses() << endl;
+
+        for (const StackDistanceAnalyzer &analyzer : analyzers)
+        {
+            if (analyzer.getNumSets() == 1)
+            {
+                cout << "\nFully associative LRU:" << endl;
+            }
+            else
+            {
+                cout << "\n" << analyzer.getNumSets() << "-set LRU:" << endl;
+            }
+            analyzer.printCurve();
+        }
+    }
+
+    void handleSweepInit(istringstream &iss)
+    {
+        size_t mem_size;
+        if (!(iss >> mem_size))
+        {
+            cerr << "Usage: sweep init <mem_size>" << endl;
+            return;
+        }
+
+        if (cache_sweep)
+            delete cache_sweep;
+
+        cache_sweep = new CacheSweep(mem_size);
+        cout << "Cache sweep initialized with " << mem_size << " bytes of memory" << endl;
+    }
+
+    void handleSweepAdd(istringstream &iss)
+    {
+        if (!cache_sweep)
+        {
+            cerr << "Error: Initialize sweep first" << endl;
+            return;
+        }
+
+        // Levels are separated by '/', each written as for add cache
+        string rest;
+        getline(iss, rest);
+        istringstream specs(rest);
+
+        vector<LevelConfig> levels;
+        string spec;
+        while (getline(specs, spec, '/'))
+        {
+            istringstream spec_iss(spec);
+            LevelConfig level;
+            string policy_str;
+            if (!(spec_iss >> level.size >> level.block_size >> level.associativity >> policy_str))
+            {
+                cerr << "Usage: sweep add <size> <block> <assoc> <policy> [wt|wb] [nwa|wa] [/ <next level> ...]" << endl;
+                return;
+            }
+
+            transform(policy_str.begin(), policy_str.end(), policy_str.begin(), ::tolower);
+            if (!parseReplacementPolicy(policy_str, level.policy) ||
+                !parseWriteOptions(spec_iss, level.write_policy, level.miss_policy))
+            {
+                return;
+            }
+            levels.push_back(level);
+        }
+
+        if (cache_sweep->addConfig(levels))
+        {
+            cout << "Added sweep configuration #" << cache_sweep->getNumConfigs() << ": "
+                 << CacheSweep::describe(levels) << endl;
+        }
+    }
+
+    bool parseSizeList(const string &list, vector<size_t> &values)
+    {
+        istringstream iss(list);
+        string item;
+        while (getline(iss, item, ','))
+        {
+            size_t value;
+            istringstream item_iss(item);
+            if (!(item_iss >> value))
+            {
+                cerr << "Error: Invalid list value: " << item << endl;
+                return false;
+            }
+            values.push_back(value);
+        }
+        return !values.empty();
+    }
+
+    void handleSweepGrid(istringstream &iss)
+    {
+        string sizes_str, blocks_str, assocs_str, policies_str;
+        if (!(iss >> sizes_str >> blocks_str >> assocs_str >> policies_str))
+        {
+            cerr << "Usage: sweep grid <sizes> <blocks> <assocs> <policies> [wt|wb] [nwa|wa]" << endl;
+            cerr << "       (comma-separated lists, e.g. sweep grid 1024,2048 16,32 1,2,4 lru,fifo)" << endl;
+            return;
+        }
+
+        if (!cache_sweep)
+        {
+            cerr << "Error: Initialize sweep first" << endl;
+            return;
+        }
+
+        vector<size_t> sizes, blocks, assocs;
+        if (!parseSizeList(sizes_str, sizes) || !parseSizeList(blocks_str, blocks) ||
+            !parseSizeList(assocs_str, assocs))
+        {
+            return;
+        }
+
+        transform(policies_str.begin(), policies_str.end(), policies_str.begin(), ::tolower);
+        vector<ReplacementPolicy> policies;
+        istringstream policies_iss(policies_str);
+        string name;
+        while (getline(policies_iss, name, ','))
+        {
+            ReplacementPolicy policy;
+            if (!parseReplacementPolicy(name, policy))
+            {
+                return;
+            }
+            policies.push_back(policy);
+        }
+
+        LevelConfig level;
+        if (!parseWriteOptions(iss, level.write_policy, level.miss_policy))
+        {
+            return;
+        }
+
+        // Every combination becomes a single-level configuration; sizes
+        // that do not divide into whole sets are skipped
+        size_t added = 0, skipped = 0;
+        for (size_t size : sizes)
+        {
+            for (size_t block_size : blocks)
+            {
+                for (size_t assoc : assocs)
+                {
+                    if (block_size == 0 || assoc == 0 || size == 0 || size % (block_size * assoc) != 0)
+                    {
+                        skipped += policies.size();
+                        continue;
+                    }
+
+                    for (ReplacementPolicy policy : policies)
+                    {
+                        level.size = size;
+                        level.block_size = block_size;
+                        level.associativity = assoc;
+                        level.policy = policy;
+                        if (cache_sweep->addConfig(vector<LevelConfig>(1, level)))
+                        {
+                            added++;
+                        }
+                    }
+                }
+            }
+        }
+
+        cout << "Added " << added << " sweep configurations";
+        if (skipped > 0)
+        {
+            cout << " (" << skipped << " with invalid geometry skipped)";
+        }
+        cout << endl;
+    }
+
+    void handleSweepRun(istringstream &iss)
+    {
+        string path;
+        if (!(iss >> path))
+        {
+            cerr << "Usage: sweep run <trace_file> [threads]" << endl;
+            return;
+        }
+
+        size_t threads = 0;
+        iss >> threads;
+
+        if (!cache_sweep || cache_sweep->getNumConfigs() == 0)
+        {
+            cerr << "Error: Add sweep configurations first" << endl;
+            return;
+        }
+
+        vector<TraceAccess> trace;
+        if (!loadTrace(path, trace))
+        {
+            return;
+        }
+
+        size_t used = cache_sweep->run(trace, threads);
+        if (used == 0)
+        {
+            return;
+        }
+
+        cout << "\n=== Cache Sweep Results ===" << endl;
+        cout << "Trace: " << path << " (" << trace.size() << " accesses), "
+             << cache_sweep->getNumConfigs() << " configurations on " << used << " threads" << endl;
+        cache_sweep->printResults();
+    }
+
+    void handleCacheStats()
+    {
+        if (!cache_initialized)
+        {
+            cerr << "Error: Initialize cache first" << endl;
+            return;
+        }
+
+        cache_hierarchy->printAllStats();
+    }
+
+    void handleInitMulticore(istringstream &iss)
+    {
+        size_t cores, mem_size;
+        if (!(iss >> cores >> mem_size))
+        {
+            cerr << "Usage: init multicore <cores> <memory_size>" << endl;
+            return;
+        }
+
+        if (cores == 0 || cores > MultiCoreHierarchy::MAX_CORES)
+        {
+            cerr << "Error: Core count must be between 1 and " << MultiCoreHierarchy::MAX_CORES << endl;
+            return;
+        }
+
+        if (multicore)
+            delete multicore;
+
+        multicore = new MultiCoreHierarchy(cores, mem_size);
+        cout << "Multi-core hierarchy initialized with " << cores << " cores and "
+             << mem_size << " bytes of memory" << endl;
+    }
+
+    void handleAddMulticoreLevel(istringstream &iss, bool shared)
+    {
+        size_t size, block_size, assoc;
+        string policy_str;
+
+        if (!(iss >> size >> block_size >> assoc >> policy_str))
+        {
+            cerr << "Usage: add " << (shared ? "shared" : "private")
+                 << " <size> <block_size> <associativity> <policy>" << endl;
+            return;
+        }
+
+        if (!multicore)
+        {
+            cerr << "Error: Initialize multicore first" << endl;
+            return;
+        }
+
+        transform(policy_str.begin(), policy_str.end(), policy_str.begin(), ::tolower);
+
+        ReplacementPolicy policy = ReplacementPolicy::LRU;
+        if (!parseReplacementPolicy(policy_str, policy))
+        {
+            return;
+        }
+
+        if (shared)
+        {
+            if (!multicore->setSharedLevel(size, block_size, assoc, policy))
+            {
+                return;
+            }
+            cout << "Set shared level: ";
+        }
+        else
+        {
+            if (!multicore->addPrivateLevel(size, block_size, assoc, policy))
+            {
+                return;
+            }
+            cout << "Added private L" << multicore->getNumPrivateLevels() << " to each of "
+                 << multicore->getNumCores() << " cores: ";
+        }
+        cout << size << " bytes, " << block_size << " block size, " << assoc << "-way, " << policy_str << endl;
+    }
+
+    void handleSetProtocol(istringstream &iss)
+    {
+        string name;
+        if (!(iss >> name))
+        {
+            cerr << "Usage: set protocol <mesi|moesi>" << endl;
+            return;
+        }
+
+        if (!multicore)
+        {
+            cerr << "Error: Initialize multicore first" << endl;
+            return;
+        }
+
+        transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+        CoherenceProtocol protocol;
+        if (name == "mesi")
+        {
+            protocol = CoherenceProtocol::MESI;
+        }
+        else if (name == "moesi")
+        {
+            protocol = CoherenceProtocol::MOESI;
+        }
+        else
+        {
+            cerr << "Unknown protocol: " << name << " (options: mesi, moesi)" << endl;
+            return;
+        }
 
-    void handleMalloc(istringstream &iss)
-    {
-        size_t size;
-        if (!(iss >> size))
+        if (!multicore->setProtocol(protocol))
         {
-            cerr << "Usage: malloc <size>" << endl;
             return;
         }
+        cout << "Coherence protocol set to " << (name == "mesi" ? "MESI" : "MOESI") << endl;
+    }
 
-        if (!memory_initialized)
+    void handleMulticoreRead(istringstream &iss)
+    {
+        size_t core, address;
+        if (!(iss >> core >> address))
         {
-            cerr << "Error: Initialize memory first" << endl;
+            cerr << "Usage: multicore read <core> <address>" << endl;
             return;
         }
 
-        if (using_buddy)
+        if (!multicore)
         {
-            buddy_allocator->malloc(size);
+            cerr << "Error: Initialize multicore first" << endl;
+            return;
         }
-        else
+
+        size_t data;
+        if (multicore->read(core, address, data))
         {
-            allocator->malloc(size);
+            cout << "Core " << core << " read address " << address << ": data = " << data
+                 << " (" << stateName(multicore->getState(core, address)) << ")" << endl;
         }
     }
 
-    void handleFree(istringstream &iss)
+    void handleMulticoreWrite(istringstream &iss)
     {
-        int block_id;
-        if (!(iss >> block_id))
+        size_t core, address, data;
+        if (!(iss >> core >> address >> data))
         {
-            cerr << "Usage: free <block_id>" << endl;
+            cerr << "Usage: multicore write <core> <address> <data>" << endl;
             return;
         }
 
-        if (!memory_initialized)
+        if (!multicore)
         {
-            cerr << "Error: Initialize memory first" << endl;
+            cerr << "Error: Initialize multicore first" << endl;
             return;
         }
 
-        if (using_buddy)
+        if (multicore->write(core, address, data))
         {
-            buddy_allocator->free(block_id);
-        }
-        else
-        {
-            allocator->free(block_id);
+            cout << "Core " << core << " wrote " << data << " to address " << address << endl;
         }
     }
 
-    void handleDumpMemory()
+    void handleMulticoreTrace(istringstream &iss)
     {
-        if (!memory_initialized)
+        string path;
+        if (!(iss >> path))
         {
-            cerr << "Error: Initialize memory first" << endl;
+            cerr << "Usage: multicore trace <file>" << endl;
             return;
         }
 
-        if (using_buddy)
+        if (!multicore)
         {
-            buddy_allocator->dumpMemory();
+            cerr << "Error: Initialize multicore first" << endl;
+            return;
         }
-        else
+
+        vector<CoreAccess> trace;
+        if (!loadCoreTrace(path, trace) || !multicore->replay(trace))
         {
-            allocator->dumpMemory();
+            return;
+        }
+
+        size_t writes = 0;
+        for (const CoreAccess &access : trace)
+        {
+            writes += access.access.is_write ? 1 : 0;
         }
+
+        cout << "Replayed " << trace.size() << " accesses from " << path << " ("
+             << trace.size() - writes << " reads, " << writes << " writes)" << endl;
     }
 
-    void handleStats()
+    void handleMulticoreStats()
     {
-        if (!memory_initialized)
+        if (!multicore)
         {
-            cerr << "Error: Initialize memory first" << endl;
+            cerr << "Error: Initialize multicore first" << endl;
             return;
         }
 
-        if (using_buddy)
+        multicore->printAllStats();
+    }
+
+    void handleMulticoreHotspots(istringstream &iss)
+    {
+        size_t count = 10;
+        if (!readOptionalCount(iss, "hotspot count", count))
         {
-            buddy_allocator->printStats();
+            return;
         }
-        else
+        if (count == 0)
         {
-            allocator->printStats();
+            cerr << "Error: Hotspot count must be at least 1" << endl;
+            return;
         }
-    }
 
-    void handleInitCache(istringstream &iss)
-    {
-        size_t mem_size;
-        if (!(iss >> mem_size))
+        if (!multicore)
         {
-            cerr << "Usage: init cache <memory_size>" << endl;
+            cerr << "Error: Initialize multicore first" << endl;
             return;
         }
 
-        if (cache_hierarchy)
-            delete cache_hierarchy;
+        multicore->printHotspots(count);
+    }
 
-        cache_hierarchy = new CacheHierarchy(mem_size);
-        cache_initialized = true;
+    static const char *stateName(CoherenceState state)
+    {
+        const char *names[] = {"I", "S", "E", "O", "M"};
+        return names[(int)state];
+    }
 
-        cout << "Cache hierarchy initialized with " << mem_size << " bytes of memory" << endl;
+    bool parsePagePolicy(const string &name, PageReplacementPolicy &policy)
+    {
+        if (name == "fifo")
+        {
+            policy = PageReplacementPolicy::FIFO;
+        }
+        else if (name == "lru")
+        {
+            policy = PageReplacementPolicy::LRU;
+        }
+        else if (name == "clock")
+        {
+            policy = PageReplacementPolicy::CLOCK;
+        }
+        else
+        {
+            cerr << "Unknown policy: " << name << endl;
+            return false;
+        }
+        return true;
     }
 
-    void handleAddCache(istringstream &iss)
+    void handleColocateInit(istringstream &iss)
     {
-        size_t size, block_size, assoc;
+        size_t virt_bits, phys_bits, page_size;
         string policy_str;
 
-        if (!(iss >> size >> block_size >> assoc >> policy_str))
+        if (!(iss >> virt_bits >> phys_bits >> page_size >> policy_str))
         {
-            cerr << "Usage: add cache <size> <block_size> <associativity> <policy>" << endl;
+            cerr << "Usage: colocate init <virtual_bits> <physical_bits> <page_size> <policy>" << endl;
             return;
         }
 
-        if (!cache_initialized)
+        if (page_size == 0 || phys_bits >= 64 || virt_bits >= 64 || ((size_t)1 << phys_bits) < page_size)
         {
-            cerr << "Error: Initialize cache first" << endl;
+            cerr << "Error: Physical memory must hold at least one page" << endl;
             return;
         }
 
         transform(policy_str.begin(), policy_str.end(), policy_str.begin(), ::tolower);
 
-        ReplacementPolicy policy;
-        if (policy_str == "fifo")
+        PageReplacementPolicy policy = PageReplacementPolicy::LRU;
+        if (!parsePagePolicy(policy_str, policy))
         {
-            policy = ReplacementPolicy::FIFO;
+            return;
         }
-        else if (policy_str == "lru")
+
+        if (colocation)
+            delete colocation;
+
+        colocation = new Colocation(virt_bits, phys_bits, page_size, policy);
+        cout << "Co-location study initialized: " << ((size_t)1 << virt_bits) << "-byte address space per thread, "
+             << ((size_t)1 << phys_bits) / page_size << " shared frames of " << page_size << " bytes, "
+             << policy_str << endl;
+    }
+
+    void handleColocateCache(istringstream &iss)
+    {
+        LevelConfig level;
+        string policy_str;
+        if (!(iss >> level.size >> level.block_size >> level.associativity >> policy_str))
         {
-            policy = ReplacementPolicy::LRU;
+            cerr << "Usage: colocate cache <size> <block> <assoc> <policy> [wt|wb] [nwa|wa]" << endl;
+            return;
         }
-        else if (policy_str == "lfu")
+
+        if (!colocation)
         {
-            policy = ReplacementPolicy::LFU;
+            cerr << "Error: Initialize colocate first" << endl;
+            return;
         }
-        else
+
+        transform(policy_str.begin(), policy_str.end(), policy_str.begin(), ::tolower);
+        if (!parseReplacementPolicy(policy_str, level.policy) ||
+            !parseWriteOptions(iss, level.write_policy, level.miss_policy))
         {
-            cerr << "Unknown policy: " << policy_str << endl;
             return;
         }
 
-        cache_hierarchy->addLevel(size, block_size, assoc, policy);
-        cout << "Added cache level: " << size << " bytes, " << block_size
-             << " block size, " << assoc << "-way, " << policy_str << endl;
+        vector<LevelConfig> levels(1, level);
+        if (colocation->addLevel(level))
+        {
+            cout << "Added shared cache level: " << CacheSweep::describe(levels) << endl;
+        }
     }
 
-    void handleCacheRead(istringstream &iss)
+    void handleColocateThread(istringstream &iss)
     {
-        size_t address;
-        if (!(iss >> address))
+        string path;
+        if (!(iss >> path))
         {
-            cerr << "Usage: cache read <address>" << endl;
+            cerr << "Usage: colocate thread <trace> [weight]" << endl;
             return;
         }
 
-        if (!cache_initialized)
+        // A weight of 0 is rejected by addThread
+        size_t weight = 1;
+        if (!readOptionalCount(iss, "thread weight", weight))
         {
-            cerr << "Error: Initialize cache first" << endl;
             return;
         }
 
-        size_t data = cache_hierarchy->read(address);
-        cout << "Read address " << address << ": data = " << data << endl;
+        if (!colocation)
+        {
+            cerr << "Error: Initialize colocate first" << endl;
+            return;
+        }
+
+        if (colocation->addThread(path, weight))
+        {
+            cout << "Added thread " << colocation->getNumThreads() - 1 << ": " << path;
+            if (weight > 1)
+            {
+                cout << " (weight " << weight << ")";
+            }
+            cout << endl;
+        }
     }
 
-    void handleCacheWrite(istringstream &iss)
+    void handleColocateRun(istringstream &iss)
     {
-        size_t address, data;
-        if (!(iss >> address >> data))
+        string mode;
+        if (!(iss >> mode))
         {
-            cerr << "Usage: cache write <address> <data>" << endl;
+            cerr << "Usage: colocate run <roundrobin|weighted|timestamp> [workers]" << endl;
             return;
         }
 
-        if (!cache_initialized)
+        // 0 (the default) runs one worker per core
+        size_t workers = 0;
+        if (!readOptionalCount(iss, "worker count", workers))
         {
-            cerr << "Error: Initialize cache first" << endl;
             return;
         }
 
-        cache_hierarchy->write(address, data);
-        cout << "Wrote " << data << " to address " << address << endl;
-    }
+        if (!colocation)
+        {
+            cerr << "Error: Initialize colocate first" << endl;
+            return;
+        }
 
-    void handleCacheStats()
-    {
-        if (!cache_initialized)
+        transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+
+        InterleavePolicy policy = InterleavePolicy::ROUND_ROBIN;
+        if (mode == "roundrobin")
         {
-            cerr << "Error: Initialize cache first" << endl;
+            policy = InterleavePolicy::ROUND_ROBIN;
+        }
+        else if (mode == "weighted")
+        {
+            policy = InterleavePolicy::WEIGHTED;
+        }
+        else if (mode == "timestamp")
+        {
+            policy = InterleavePolicy::TIMESTAMP;
+        }
+        else
+        {
+            cerr << "Unknown interleaving: " << mode << " (options: roundrobin, weighted, timestamp)" << endl;
             return;
         }
 
-        cache_hierarchy->printAllStats();
+        if (colocation->run(policy, workers))
+        {
+            colocation->printResults();
+        }
     }
 
     void handleInitVM(istringstream &iss)
@@ -363,22 +1476,9 @@ private:
 
         transform(policy_str.begin(), policy_str.end(), policy_str.begin(), ::tolower);
 
-        PageReplacementPolicy policy;
-        if (policy_str == "fifo")
-        {
-            policy = PageReplacementPolicy::FIFO;
-        }
-        else if (policy_str == "lru")
+        PageReplacementPolicy policy = PageReplacementPolicy::LRU;
+        if (!parsePagePolicy(policy_str, policy))
         {
-            policy = PageReplacementPolicy::LRU;
-        }
-        else if (policy_str == "clock")
-        {
-            policy = PageReplacementPolicy::CLOCK;
-        }
-        else
-        {
-            cerr << "Unknown policy: " << policy_str << endl;
             return;
         }
 
@@ -443,22 +1543,9 @@ private:
 
         transform(policy_str.begin(), policy_str.end(), policy_str.begin(), ::tolower);
 
-        PageReplacementPolicy policy;
-        if (policy_str == "fifo")
-        {
-            policy = PageReplacementPolicy::FIFO;
-        }
-        else if (policy_str == "lru")
-        {
-            policy = PageReplacementPolicy::LRU;
-        }
-        else if (policy_str == "clock")
-        {
-            policy = PageReplacementPolicy::CLOCK;
-        }
-        else
+        PageReplacementPolicy policy = PageReplacementPolicy::LRU;
+        if (!parsePagePolicy(policy_str, policy))
         {
-            cerr << "Unknown policy: " << policy_str << endl;
             return;
         }
 
@@ -469,11 +1556,12 @@ private:
         vm_initialized = true;
 
         // Initialize Cache with physical memory size
-        size_t phys_mem_size = (1 << phys_bits);
+        size_t phys_mem_size = (size_t)1 << phys_bits;
         if (cache_hierarchy)
             delete cache_hierarchy;
         cache_hierarchy = new CacheHierarchy(phys_mem_size);
         cache_initialized = true;
+        integrated_latency.reset();
 
         // Add default cache levels (L1 and L2)
         cache_hierarchy->addLevel(512, 16, 4, ReplacementPolicy::LRU);
@@ -512,6 +1600,7 @@ private:
         cout << "3. Cache Hierarchy Access:" << endl;
         size_t data = cache_hierarchy->read(phys_addr);
         cout << "4. Data Retrieved: " << data << endl;
+        recordIntegratedLatency();
         cout << "   [Flow: Virtual Address → Page Table → Physical Address → Cache → Memory]" << endl;
     }
 
@@ -542,9 +1631,19 @@ private:
         cout << "3. Cache Hierarchy Write:" << endl;
         cache_hierarchy->write(phys_addr, data);
         cout << "4. Data Written: " << data << endl;
+        recordIntegratedLatency();
         cout << "   [Flow: Virtual Address → Page Table → Physical Address → Cache → Memory]" << endl;
     }
 
+    void recordIntegratedLatency()
+    {
+        uint64_t translation = virtual_memory->getLastTranslationCycles();
+        uint64_t memory = cache_hierarchy->getLastAccessCycles();
+        integrated_latency.record(translation + memory);
+        cout << "   Latency: " << translation + memory << " cycles (translation "
+             << translation << " + memory " << memory << ")" << endl;
+    }
+
     void handleIntegratedStats()
     {
         if (!vm_initialized || !cache_initialized)
@@ -558,12 +1657,21 @@ private:
         virtual_memory->printStats();
         cout << "\n--- Cache Hierarchy ---" << endl;
         cache_hierarchy->printAllStats();
+
+        cout << "\n--- Latency ---" << endl;
+        cout << "Accesses: " << integrated_latency.getAccesses() << endl;
+        cout << "Total cycles: " << integrated_latency.getTotalCycles() << endl;
+        cout << "Average memory access time: " << fixed << setprecision(2)
+             << integrated_latency.getAverage() << " cycles" << endl;
+        cout << "Worst access: " << integrated_latency.getMaxCycles() << " cycles" << endl;
+        integrated_latency.printHistogram();
     }
 
 public:
     MemorySimulator()
         : allocator(nullptr), buddy_allocator(nullptr),
-          cache_hierarchy(nullptr), virtual_memory(nullptr),
+          cache_hierarchy(nullptr), virtual_memory(nullptr), cache_sweep(nullptr), multicore(nullptr),
+          colocation(nullptr),
           memory_initialized(false), cache_initialized(false),
           vm_initialized(false), using_buddy(false)
     {
@@ -579,6 +1687,12 @@ public:
             delete cache_hierarchy;
         if (virtual_memory)
             delete virtual_memory;
+        if (cache_sweep)
+            delete cache_sweep;
+        if (multicore)
+            delete multicore;
+        if (colocation)
+            delete colocation;
     }
 
     void run()
@@ -648,6 +1762,10 @@ public:
                 {
                     handleInitIntegrated(iss);
                 }
+                else if (subcommand == "multicore")
+                {
+                    handleInitMulticore(iss);
+                }
                 else
                 {
                     cerr << "Unknown init command: " << subcommand << endl;
@@ -663,6 +1781,26 @@ public:
                 {
                     handleSetAllocator(iss);
                 }
+                else if (subcommand == "inclusion")
+                {
+                    handleSetInclusion(iss);
+                }
+                else if (subcommand == "latency")
+                {
+                    handleSetLatency(iss);
+                }
+                else if (subcommand == "classify")
+                {
+                    handleSetClassify(iss);
+                }
+                else if (subcommand == "mshrs")
+                {
+                    handleSetMSHRs(iss);
+                }
+                else if (subcommand == "protocol")
+                {
+                    handleSetProtocol(iss);
+                }
                 else
                 {
                     cerr << "Unknown set command: " << subcommand << endl;
@@ -705,6 +1843,26 @@ public:
                 {
                     handleAddCache(iss);
                 }
+                else if (subcommand == "prefetcher")
+                {
+                    handleAddPrefetcher(iss);
+                }
+                else if (subcommand == "victim")
+                {
+                    handleAddSideCache(iss, SideCacheType::VICTIM);
+                }
+                else if (subcommand == "misscache")
+                {
+                    handleAddSideCache(iss, SideCacheType::MISS);
+                }
+                else if (subcommand == "private")
+                {
+                    handleAddMulticoreLevel(iss, false);
+                }
+                else if (subcommand == "shared")
+                {
+                    handleAddMulticoreLevel(iss, true);
+                }
                 else
                 {
                     cerr << "Unknown add command: " << subcommand << endl;
@@ -724,6 +1882,10 @@ public:
                 {
                     handleCacheWrite(iss);
                 }
+                else if (subcommand == "trace")
+                {
+                    handleCacheTrace(iss);
+                }
                 else if (subcommand == "stats")
                 {
                     handleCacheStats();
@@ -733,6 +1895,95 @@ public:
                     cerr << "Unknown cache command: " << subcommand << endl;
                 }
             }
+            else if (command == "analyze")
+            {
+                handleAnalyze(iss);
+            }
+            else if (command == "sweep")
+            {
+                string subcommand;
+                iss >> subcommand;
+                transform(subcommand.begin(), subcommand.end(), subcommand.begin(), ::tolower);
+
+                if (subcommand == "init")
+                {
+                    handleSweepInit(iss);
+                }
+                else if (subcommand == "add")
+                {
+                    handleSweepAdd(iss);
+                }
+                else if (subcommand == "grid")
+                {
+                    handleSweepGrid(iss);
+                }
+                else if (subcommand == "run")
+                {
+                    handleSweepRun(iss);
+                }
+                else
+                {
+                    cerr << "Unknown sweep command: " << subcommand << endl;
+                }
+            }
+            else if (command == "colocate")
+            {
+                string subcommand;
+                iss >> subcommand;
+                transform(subcommand.begin(), subcommand.end(), subcommand.begin(), ::tolower);
+
+                if (subcommand == "init")
+                {
+                    handleColocateInit(iss);
+                }
+                else if (subcommand == "cache")
+                {
+                    handleColocateCache(iss);
+                }
+                else if (subcommand == "thread")
+                {
+                    handleColocateThread(iss);
+                }
+                else if (subcommand == "run")
+                {
+                    handleColocateRun(iss);
+                }
+                else
+                {
+                    cerr << "Unknown colocate command: " << subcommand << endl;
+                }
+            }
+            else if (command == "multicore")
+            {
+                string subcommand;
+                iss >> subcommand;
+                transform(subcommand.begin(), subcommand.end(), subcommand.begin(), ::tolower);
+
+                if (subcommand == "read")
+                {
+                    handleMulticoreRead(iss);
+                }
+                else if (subcommand == "write")
+                {
+                    handleMulticoreWrite(iss);
+                }
+                else if (subcommand == "trace")
+                {
+                    handleMulticoreTrace(iss);
+                }
+                else if (subcommand == "stats")
+                {
+                    handleMulticoreStats();
+                }
+                else if (subcommand == "hotspots")
+                {
+                    handleMulticoreHotspots(iss);
+                }
+                else
+                {
+                    cerr << "Unknown multicore command: " << subcommand << endl;
+                }
+            }
             else if (command == "vm")
             {
                 string subcommand;
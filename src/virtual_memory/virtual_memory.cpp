@@ -6,51 +6,78 @@
 
 using namespace std;
 
+static const uint64_t DEFAULT_FAULT_LATENCY = 10000;
+
 VirtualMemory::VirtualMemory(size_t virtual_bits, size_t physical_bits,
-                             size_t page_sz, PageReplacementPolicy pol)
+                             size_t page_sz, PageReplacementPolicy pol,
+                             size_t spaces, bool verbose_output)
     : virtual_address_bits(virtual_bits), physical_address_bits(physical_bits),
-      page_size(page_sz), policy(pol), clock_hand(0), current_time(0),
-      page_faults(0), page_hits(0)
+      page_size(page_sz), address_spaces(spaces), verbose(verbose_output),
+      policy(pol), clock_hand(0), current_time(0),
+      page_faults(0), page_hits(0), fault_latency(DEFAULT_FAULT_LATENCY),
+      fault_cycles(0), last_translation_cycles(0)
 {
 
-    num_virtual_pages = (1 << virtual_bits) / page_size;
-    num_physical_frames = (1 << physical_bits) / page_size;
+    pow2_pages = page_size > 0 && (page_size & (page_size - 1)) == 0;
+    page_shift = pow2_pages ? 63 - __builtin_clzll(page_size) : 0;
+    offset_mask = pow2_pages ? page_size - 1 : 0;
+
+    num_virtual_pages = ((size_t)1 << virtual_bits) / page_size;
+    num_physical_frames = ((size_t)1 << physical_bits) / page_size;
 
-    page_table.resize(num_virtual_pages);
+    page_table.resize(num_virtual_pages * address_spaces);
     frame_allocation.resize(num_physical_frames, false);
     frame_to_page.resize(num_physical_frames, 0);
 
+    if (!verbose)
+    {
+        return;
+    }
+
     cout << "Virtual Memory initialized:" << endl;
-    cout << "  Virtual address space: " << (1 << virtual_bits) << " bytes" << endl;
-    cout << "  Physical address space: " << (1 << physical_bits) << " bytes" << endl;
+    cout << "  Virtual address space: " << ((size_t)1 << virtual_bits) << " bytes" << endl;
+    cout << "  Physical address space: " << ((size_t)1 << physical_bits) << " bytes" << endl;
     cout << "  Page size: " << page_size << " bytes" << endl;
     cout << "  Virtual pages: " << num_virtual_pages << endl;
     cout << "  Physical frames: " << num_physical_frames << endl;
+    if (address_spaces > 1)
+    {
+        cout << "  Address spaces: " << address_spaces << endl;
+    }
 }
 
 size_t VirtualMemory::getPageNumber(size_t virtual_address)
 {
+    if (pow2_pages)
+    {
+        return virtual_address >> page_shift;
+    }
     return virtual_address / page_size;
 }
 
 size_t VirtualMemory::getOffset(size_t virtual_address)
 {
+    if (pow2_pages)
+    {
+        return virtual_address & offset_mask;
+    }
     return virtual_address % page_size;
 }
 
-int VirtualMemory::findFreeFrame()
+bool VirtualMemory::findFreeFrame(size_t &frame)
 {
     for (size_t i = 0; i < num_physical_frames; i++)
     {
         if (!frame_allocation[i])
         {
-            return i;
+            frame = i;
+            return true;
         }
     }
-    return -1;
+    return false;
 }
 
-int VirtualMemory::selectVictimPage()
+bool VirtualMemory::selectVictimPage(size_t &page)
 {
     switch (policy)
     {
@@ -58,27 +85,28 @@ int VirtualMemory::selectVictimPage()
     {
         if (fifo_queue.empty())
         {
-            return -1;
+            return false;
         }
-        size_t victim_page = fifo_queue.front();
+        page = fifo_queue.front();
         fifo_queue.pop();
-        return victim_page;
+        return true;
     }
 
     case PageReplacementPolicy::LRU:
     {
-        int lru_page = -1;
-        int oldest_time = current_time;
+        bool found = false;
+        uint64_t oldest_time = current_time;
 
-        for (size_t i = 0; i < num_virtual_pages; i++)
+        for (size_t i = 0; i < page_table.size(); i++)
         {
             if (page_table[i].valid && page_table[i].timestamp < oldest_time)
             {
                 oldest_time = page_table[i].timestamp;
-                lru_page = i;
+                page = i;
+                found = true;
             }
         }
-        return lru_page;
+        return found;
     }
 
     case PageReplacementPolicy::CLOCK:
@@ -86,18 +114,19 @@ int VirtualMemory::selectVictimPage()
         while (true)
         {
             size_t frame = clock_hand;
-            size_t page = frame_to_page[frame];
+            size_t candidate = frame_to_page[frame];
 
-            if (page_table[page].valid && page_table[page].frame_number == frame)
+            if (page_table[candidate].valid && page_table[candidate].frame_number == frame)
             {
-                if (!page_table[page].reference)
+                if (!page_table[candidate].reference)
                 {
                     clock_hand = (clock_hand + 1) % num_physical_frames;
-                    return page;
+                    page = candidate;
+                    return true;
                 }
                 else
                 {
-                    page_table[page].reference = false;
+                    page_table[candidate].reference = false;
                 }
             }
 
@@ -106,7 +135,7 @@ int VirtualMemory::selectVictimPage()
     }
     }
 
-    return -1;
+    return false;
 }
 
 void VirtualMemory::loadPage(size_t page_number, size_t frame_number)
@@ -134,7 +163,7 @@ void VirtualMemory::evictPage(size_t frame_number)
     {
         page_table[old_page].valid = false;
 
-        if (page_table[old_page].dirty)
+        if (page_table[old_page].dirty && verbose)
         {
             cout << "  [Write-back] Page " << old_page << " written to disk" << endl;
         }
@@ -143,37 +172,48 @@ void VirtualMemory::evictPage(size_t frame_number)
     frame_allocation[frame_number] = false;
 }
 
-size_t VirtualMemory::translate(size_t virtual_address)
+size_t VirtualMemory::translate(size_t virtual_address, size_t space)
 {
     size_t page_number = getPageNumber(virtual_address);
     size_t offset = getOffset(virtual_address);
 
-    if (page_number >= num_virtual_pages)
+    if (page_number >= num_virtual_pages || space >= address_spaces)
     {
         cerr << "Error: Invalid virtual address " << virtual_address << endl;
         return 0;
     }
+    page_number += space * num_virtual_pages;
+
+    last_translation_cycles = 0;
 
     if (!page_table[page_number].valid)
     {
         // Page fault
-        cout << "[Page Fault] Virtual address 0x" << hex << virtual_address
-             << " (page " << dec << page_number << ")" << endl;
+        if (verbose)
+        {
+            cout << "[Page Fault] Virtual address 0x" << hex << virtual_address
+                 << " (page " << dec << page_number << ")" << endl;
+        }
         page_faults++;
+        last_translation_cycles = fault_latency;
+        fault_cycles += fault_latency;
 
         // Find free frame or evict
-        int frame = findFreeFrame();
+        size_t frame;
 
-        if (frame == -1)
+        if (!findFreeFrame(frame))
         {
             // Need to evict
-            int victim_page = selectVictimPage();
+            size_t victim_page;
 
-            if (victim_page >= 0)
+            if (selectVictimPage(victim_page))
             {
                 frame = page_table[victim_page].frame_number;
-                cout << "  [Eviction] Page " << victim_page
-                     << " evicted from frame " << frame << endl;
+                if (verbose)
+                {
+                    cout << "  [Eviction] Page " << victim_page
+                         << " evicted from frame " << frame << endl;
+                }
                 evictPage(frame);
             }
             else
@@ -184,8 +224,11 @@ size_t VirtualMemory::translate(size_t virtual_address)
         }
 
         // Load page
-        cout << "  [Load] Page " << page_number << " loaded into frame "
-             << frame << endl;
+        if (verbose)
+        {
+            cout << "  [Load] Page " << page_number << " loaded into frame "
+                 << frame << endl;
+        }
         loadPage(page_number, frame);
     }
     else
@@ -196,7 +239,9 @@ size_t VirtualMemory::translate(size_t virtual_address)
         page_table[page_number].reference = true;
     }
 
-    size_t physical_address = page_table[page_number].frame_number * page_size + offset;
+    size_t frame_number = page_table[page_number].frame_number;
+    size_t physical_address = pow2_pages ? (frame_number << page_shift) | offset
+                                         : frame_number * page_size + offset;
     return physical_address;
 }
 
@@ -209,7 +254,7 @@ void VirtualMemory::accessPage(size_t virtual_address)
 
 void VirtualMemory::printStats()
 {
-    size_t total_accesses = page_hits + page_faults;
+    uint64_t total_accesses = page_hits + page_faults;
     double hit_ratio = total_accesses > 0 ? (100.0 * page_hits / total_accesses) : 0.0;
 
     cout << "\n=== Virtual Memory Statistics ===" << endl;
@@ -218,8 +263,10 @@ void VirtualMemory::printStats()
     cout << "Total accesses: " << total_accesses << endl;
     cout << "Hit ratio: " << fixed << setprecision(2)
          << hit_ratio << "%" << endl;
+    cout << "Page fault service time: " << fault_latency << " cycles" << endl;
+    cout << "Fault cycles: " << fault_cycles << endl;
 
-    int valid_pages = 0;
+    size_t valid_pages = 0;
     for (const auto &entry : page_table)
     {
         if (entry.valid)
@@ -235,7 +282,7 @@ void VirtualMemory::printPageTable()
     cout << "Page | Valid | Frame | Dirty | Ref | Time" << endl;
     cout << "-----+-------+-------+-------+-----+------" << endl;
 
-    for (size_t i = 0; i < num_virtual_pages; i++)
+    for (size_t i = 0; i < page_table.size(); i++)
     {
         if (page_table[i].valid)
         {
@@ -252,6 +299,6 @@ void VirtualMemory::printPageTable()
 
 double VirtualMemory::getHitRatio() const
 {
-    size_t total = page_hits + page_faults;
+    uint64_t total = page_hits + page_faults;
     return total > 0 ? (100.0 * page_hits / total) : 0.0;
 }